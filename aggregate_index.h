@@ -0,0 +1,232 @@
+/**
+ * \file	aggregate_index.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __aggregate_index_h
+#define __aggregate_index_h
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+/// number of elements per block of the min/max part of the aggregate index
+#ifndef TUPLE_VECTOR_AGGREGATE_BLOCK
+#define TUPLE_VECTOR_AGGREGATE_BLOCK 64
+#endif
+
+/**
+ * \brief type used to sum up values of type V: 64 bit integers for integral types, at least
+ *		double for floating point types and V itself for anything else
+ */
+template<typename V>
+struct aggregate_sum {
+	typedef typename std::conditional<std::is_integral<V>::value,
+		typename std::conditional<std::is_signed<V>::value, int64_t, uint64_t>::type,
+		typename std::conditional<std::is_floating_point<V>::value && sizeof(V) <= sizeof(double), double, V>::type
+	>::type type;
+};
+
+/**
+ * \brief count, sum, minimum and maximum of the values within a time window
+ * \tparam V value type
+ */
+template<typename V>
+struct window_aggregate {
+	typedef typename aggregate_sum<V>::type sum_type;
+
+	/// number of elements in the window
+	size_t count = 0;
+	/// sum of all values in the window
+	sum_type sum = sum_type();
+	/// smallest value in the window, only meaningful if count > 0
+	V min = V();
+	/// largest value in the window, only meaningful if count > 0
+	V max = V();
+
+	/// average of all values in the window, NaN for an empty window
+	double mean() const { return count ? (double)sum / count : std::numeric_limits<double>::quiet_NaN(); }
+};
+
+/**
+ * \brief Optional index over the values of a container that answers count, sum, min and max of
+ *		any range of elements in O(1):
+ *		- sum and count come from prefix sums, i.e. sum[first, last) = prefix[last] - prefix[first]
+ *		- min and max come from a sparse table over blocks of TUPLE_VECTOR_AGGREGATE_BLOCK elements
+ *		  (entry k of block b holds the min/max of blocks b .. b + 2^k - 1) plus the running min/max
+ *		  from the start of each block and to the end of each block. A range spanning several
+ *		  blocks is covered by the tail of its first block, at most two overlapping sparse table
+ *		  entries and the head of its last block.
+ *		Ranges shorter than one block are simply walked: their values are right next to the keys
+ *		the lookup has just pulled into the cache, whereas the index would add two more misses.
+ *		Everything is built in a single pass in element order, so appending only extends it.
+ *		The prefix sum and running min/max of an element are kept together, so a query touches
+ *		about two cache lines plus two for the sparse tables. Memory is 5 values per element plus
+ *		2 * log2(n / TUPLE_VECTOR_AGGREGATE_BLOCK) values per block. Note that floating point
+ *		prefix sums lose precision relative to the total sum of all values before the window.
+ *		The index does not store the values, all methods get a functor returning the value of
+ *		the i-th element instead.
+ * \tparam V value type, needs operator+, operator- and operator<
+ */
+template<typename V>
+class aggregate_index {
+public:
+	typedef typename window_aggregate<V>::sum_type sum_type;
+	static constexpr size_t block = TUPLE_VECTOR_AGGREGATE_BLOCK;
+	static_assert(block > 1, "TUPLE_VECTOR_AGGREGATE_BLOCK must be greater than 1");
+
+	/// true if build() was called since the last drop()
+	bool enabled() const { return m_enabled; }
+
+	/**
+	 * \brief (re)build the index over n elements
+	 * \param get functor returning the value of the i-th element
+	 */
+	template<typename Get>
+	void build(size_t n, Get get) {
+		drop();
+		m_enabled = true;
+		extend(n, get);
+	}
+
+	/// remove the index and free its memory
+	void drop() {
+		m_enabled = false;
+		m_total = sum_type();
+		std::vector<entry>().swap(m_entries);
+		std::vector<std::vector<V>>().swap(m_table_min);
+		std::vector<std::vector<V>>().swap(m_table_max);
+	}
+
+	/**
+	 * \brief add the elements from size() up to n to the index
+	 * \param get functor returning the value of the i-th element
+	 */
+	template<typename Get>
+	void extend(size_t n, Get get) {
+		for (size_t i = size(); i < n; ++i)
+			_push(i, get);
+	}
+
+	/// number of elements covered by the index
+	size_t size() const { return m_entries.size(); }
+
+	/// memory used by the index in bytes
+	size_t bytes() const {
+		size_t b = m_entries.capacity() * sizeof(entry);
+		for (size_t k = 0; k < m_table_min.size(); ++k)
+			b += (m_table_min[k].capacity() + m_table_max[k].capacity()) * sizeof(V);
+		return b;
+	}
+
+	/**
+	 * \brief count, sum, min and max of the elements [first, last)
+	 * \param get functor returning the value of the i-th element
+	 */
+	template<typename Get>
+	window_aggregate<V> query(size_t first, size_t last, Get get) const {
+		window_aggregate<V> r;
+		if (first >= last || last - first < block)
+			return walk(first, last, get);
+		const entry &f = m_entries[first], &l = m_entries[last - 1];
+		r.count = last - first;
+		r.sum = (last < m_entries.size() ? m_entries[last].sum : m_total) - f.sum;
+		const size_t bf = first / block, bl = (last - 1) / block;
+		if (bf == bl) {
+			// the range is exactly one whole block
+			r.min = l.head_min;
+			r.max = l.head_max;
+			return r;
+		}
+		r.min = std::min(f.tail_min, l.head_min);
+		r.max = std::max(f.tail_max, l.head_max);
+		if (bl - bf > 1) {
+			// whole blocks bf + 1 .. bl - 1, covered by two possibly overlapping power of 2 runs
+			const size_t a = bf + 1, k = 63 - __builtin_clzll(bl - a);
+			r.min = std::min(r.min, std::min(m_table_min[k][a], m_table_min[k][bl - ((size_t)1 << k)]));
+			r.max = std::max(r.max, std::max(m_table_max[k][a], m_table_max[k][bl - ((size_t)1 << k)]));
+		}
+		return r;
+	}
+
+	/**
+	 * \brief count, sum, min and max of the elements [first, last) by walking over all of them,
+	 *		used when there is no index and for ranges shorter than one block
+	 * \param get functor returning the value of the i-th element
+	 */
+	template<typename Get>
+	static window_aggregate<V> walk(size_t first, size_t last, Get get) {
+		window_aggregate<V> r;
+		if (first >= last)
+			return r;
+		r.count = last - first;
+		r.min = r.max = get(first);
+		for (size_t i = first; i < last; ++i) {
+			const V &v = get(i);
+			r.sum = r.sum + v;
+			r.min = std::min(r.min, v);
+			r.max = std::max(r.max, v);
+		}
+		return r;
+	}
+
+private:
+	/// everything the index keeps per element
+	struct entry {
+		/// sum of all values before this element
+		sum_type sum;
+		/// min/max from the start of the block up to and including this element
+		V head_min, head_max;
+		/// min/max from this element up to the end of the block, set once the block is complete
+		V tail_min, tail_max;
+	};
+
+	/// add element i, all elements before it have already been added
+	template<typename Get>
+	void _push(size_t i, Get get) {
+		const V &v = get(i);
+		bool head = i % block == 0;
+		m_entries.push_back(entry{m_total, head ? v : std::min(m_entries.back().head_min, v),
+			head ? v : std::max(m_entries.back().head_max, v), v, v});
+		m_total = m_total + v;
+		if (i % block != block - 1)
+			return;
+		// the block is complete, compute the running min/max to its end
+		const size_t b0 = i + 1 - block;
+		for (size_t j = i; j-- > b0; ) {
+			m_entries[j].tail_min = std::min(m_entries[j].tail_min, m_entries[j + 1].tail_min);
+			m_entries[j].tail_max = std::max(m_entries[j].tail_max, m_entries[j + 1].tail_max);
+		}
+		// add the block to the sparse table, every level gets the entry ending with this block
+		const size_t b = i / block;
+		if (m_table_min.empty()) {
+			m_table_min.emplace_back();
+			m_table_max.emplace_back();
+		}
+		m_table_min[0].push_back(m_entries[i].head_min);
+		m_table_max[0].push_back(m_entries[i].head_max);
+		for (size_t k = 1; ((size_t)1 << k) <= b + 1; ++k) {
+			if (m_table_min.size() <= k) {
+				m_table_min.emplace_back();
+				m_table_max.emplace_back();
+			}
+			const size_t a = b + 1 - ((size_t)1 << k), h = a + ((size_t)1 << (k - 1));
+			m_table_min[k].push_back(std::min(m_table_min[k - 1][a], m_table_min[k - 1][h]));
+			m_table_max[k].push_back(std::max(m_table_max[k - 1][a], m_table_max[k - 1][h]));
+		}
+	}
+
+	/// true if build() was called since the last drop()
+	bool m_enabled = false;
+	/// sum of all values
+	sum_type m_total = sum_type();
+	/// prefix sums and running min/max of every element
+	std::vector<entry> m_entries;
+	/// sparse tables over the min/max of complete blocks
+	std::vector<std::vector<V>> m_table_min, m_table_max;
+};
+
+#endif /* __aggregate_index_h */
@@ -0,0 +1,316 @@
+/**
+ * \file	allocators.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __allocators_h
+#define __allocators_h
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/// size of a huge page, allocations of at least this size are backed by huge pages
+#ifndef TUPLE_VECTOR_HUGE_PAGE
+#define TUPLE_VECTOR_HUGE_PAGE (2 * 1024 * 1024)
+#endif
+
+/// how huge_page_allocator backs its allocations
+enum class huge_page_mode {
+	none,		///< plain 4K pages, transparent huge pages are disabled for the range (MADV_NOHUGEPAGE)
+	madvise,	///< transparent huge pages requested with MADV_HUGEPAGE
+	hugetlb		///< explicit huge pages (MAP_HUGETLB) from the pool reserved in /proc/sys/vm/nr_hugepages,
+				///< falls back to madvise if the pool is exhausted
+};
+
+/**
+ * \brief allocate size bytes of page aligned memory with mmap, see huge_page_allocator
+ * \return pointer to the memory or nullptr if mmap failed
+ */
+inline void *huge_page_map(size_t size, huge_page_mode mode)
+{
+#ifdef __linux__
+#ifdef MAP_HUGETLB
+	if (mode == huge_page_mode::hugetlb) {
+		void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (p != MAP_FAILED)
+			return p;
+		mode = huge_page_mode::madvise;
+	}
+#endif
+	// transparent huge pages need a huge page aligned range: over-allocate and trim
+	const size_t page = TUPLE_VECTOR_HUGE_PAGE;
+	char *p = (char *)mmap(nullptr, size + page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == (char *)MAP_FAILED)
+		return nullptr;
+	char *aligned = (char *)(((uintptr_t)p + page - 1) & ~(uintptr_t)(page - 1));
+	if (aligned > p)
+		munmap(p, aligned - p);
+	munmap(aligned + size, p + page - aligned);
+#ifdef MADV_HUGEPAGE
+	madvise(aligned, size, mode == huge_page_mode::none ? MADV_NOHUGEPAGE : MADV_HUGEPAGE);
+#endif
+	return aligned;
+#else
+	(void)mode;
+	return ::operator new(size, std::nothrow);
+#endif
+}
+
+/// release memory returned by huge_page_map()
+inline void huge_page_unmap(void *p, size_t size)
+{
+#ifdef __linux__
+	munmap(p, size);
+#else
+	(void)size;
+	::operator delete(p);
+#endif
+}
+
+/**
+ * \brief Allocator which backs every allocation of at least TUPLE_VECTOR_HUGE_PAGE bytes with
+ *		huge pages, rounded up to a whole number of them. Smaller allocations come from
+ *		operator new. A lookup in a large series probes elements far apart from each other,
+ *		so with 4K pages nearly every probe is a TLB miss - with 2M pages the TLB covers
+ *		512 times more of the series. Use it e.g. as
+ *		tuple_vector<K, V, no_search_stats, huge_page_allocator<std::pair<K,V>>>.
+ *		On anything but Linux, all memory comes from operator new.
+ * \tparam T element type
+ * \tparam Mode how the huge pages are requested
+ */
+template<typename T, huge_page_mode Mode = huge_page_mode::madvise>
+class huge_page_allocator {
+public:
+	typedef T value_type;
+
+	template<typename U>
+	struct rebind {
+		typedef huge_page_allocator<U, Mode> other;
+	};
+
+	huge_page_allocator() noexcept { }
+	template<typename U>
+	huge_page_allocator(const huge_page_allocator<U, Mode> &) noexcept { }
+
+	T *allocate(size_t n) {
+		const size_t size = n * sizeof(T);
+		if (size < TUPLE_VECTOR_HUGE_PAGE)
+			return (T *)::operator new(size);
+		void *p = huge_page_map(_round(size), Mode);
+		if (!p)
+			throw std::bad_alloc();
+		return (T *)p;
+	}
+
+	void deallocate(T *p, size_t n) noexcept {
+		const size_t size = n * sizeof(T);
+		if (size < TUPLE_VECTOR_HUGE_PAGE)
+			::operator delete(p);
+		else
+			huge_page_unmap(p, _round(size));
+	}
+
+	template<typename U>
+	bool operator==(const huge_page_allocator<U, Mode> &) const noexcept { return true; }
+	template<typename U>
+	bool operator!=(const huge_page_allocator<U, Mode> &) const noexcept { return false; }
+
+private:
+	static size_t _round(size_t size) {
+		return (size + TUPLE_VECTOR_HUGE_PAGE - 1) / TUPLE_VECTOR_HUGE_PAGE * TUPLE_VECTOR_HUGE_PAGE;
+	}
+};
+
+/**
+ * \brief Monotonic arena: hands out memory by bumping a pointer through large blocks and only
+ *		frees it all at once, when the arena is released or destroyed. Building many small
+ *		per-instrument series in one arena keeps them next to each other and costs no
+ *		malloc() per series. The arena either grows by allocating blocks of block_size bytes
+ *		(backed by huge_page_allocator if they are big enough), or works within a fixed buffer
+ *		provided by the caller, in which case running out of space throws std::bad_alloc.
+ *		An arena is not thread-safe.
+ */
+class monotonic_arena {
+public:
+	/// growing arena allocating blocks of at least block_size bytes
+	explicit monotonic_arena(size_t block_size = TUPLE_VECTOR_HUGE_PAGE) : m_block_size(block_size) { }
+
+	/// arena within the given buffer, which must outlive the arena
+	monotonic_arena(void *buf, size_t size) : m_block_size(0), m_buf((char *)buf), m_ptr(m_buf), m_end(m_buf + size) { }
+
+	monotonic_arena(const monotonic_arena &) = delete;
+	monotonic_arena &operator=(const monotonic_arena &) = delete;
+
+	~monotonic_arena() { release(); }
+
+	/// size bytes aligned to align, which must be a power of 2
+	void *allocate(size_t size, size_t align) {
+		char *p = (char *)(((uintptr_t)m_ptr + align - 1) & ~(uintptr_t)(align - 1));
+		if (!m_ptr || p + size > m_end) {
+			if (!m_block_size)
+				throw std::bad_alloc();
+			const size_t n = std::max(m_block_size, size + align);
+			m_blocks.push_back(block{huge_page_allocator<char>().allocate(n), n});
+			m_ptr = m_blocks.back().data;
+			m_end = m_ptr + n;
+			p = (char *)(((uintptr_t)m_ptr + align - 1) & ~(uintptr_t)(align - 1));
+		}
+		m_ptr = p + size;
+		m_used += size;
+		return p;
+	}
+
+	/// free all blocks or rewind to the start of the caller's buffer, everything allocated becomes invalid
+	void release() {
+		for (auto &b : m_blocks)
+			huge_page_allocator<char>().deallocate(b.data, b.size);
+		m_blocks.clear();
+		if (m_block_size)
+			m_ptr = m_end = nullptr;
+		else
+			m_ptr = m_buf;
+		m_used = 0;
+	}
+
+	/// number of bytes handed out so far
+	size_t used() const { return m_used; }
+
+	/// number of bytes allocated for blocks
+	size_t reserved() const {
+		size_t n = 0;
+		for (auto &b : m_blocks)
+			n += b.size;
+		return n;
+	}
+
+private:
+	struct block {
+		char *data;
+		size_t size;
+	};
+
+	size_t m_block_size;
+	/// start of the caller's buffer, nullptr for a growing arena
+	char *m_buf = nullptr;
+	char *m_ptr = nullptr, *m_end = nullptr;
+	size_t m_used = 0;
+	std::vector<block> m_blocks;
+};
+
+/**
+ * \brief Allocator taking its memory from a monotonic_arena, deallocate() does nothing.
+ *		Since a growing std::vector leaves its old buffers behind in the arena, reserve() the
+ *		final size first where it is known.
+ * \tparam T element type
+ */
+template<typename T>
+class arena_allocator {
+public:
+	typedef T value_type;
+
+	arena_allocator(monotonic_arena &arena) noexcept : m_arena(&arena) { }
+	template<typename U>
+	arena_allocator(const arena_allocator<U> &x) noexcept : m_arena(x.arena()) { }
+
+	T *allocate(size_t n) { return (T *)m_arena->allocate(n * sizeof(T), alignof(T)); }
+	void deallocate(T *, size_t) noexcept { }
+
+	monotonic_arena *arena() const noexcept { return m_arena; }
+
+	template<typename U>
+	bool operator==(const arena_allocator<U> &x) const noexcept { return m_arena == x.arena(); }
+	template<typename U>
+	bool operator!=(const arena_allocator<U> &x) const noexcept { return m_arena != x.arena(); }
+
+private:
+	monotonic_arena *m_arena;
+};
+
+/**
+ * \brief ask the kernel to place the pages of [p, p + size) on the given NUMA node with mbind()
+ *		(MPOL_PREFERRED), before they are touched for the first time. Called directly, without
+ *		libnuma, so nothing needs to be linked. If the node runs out of memory, the kernel takes
+ *		the pages from another one.
+ * \return false if the binding failed or is not supported, the memory can be used anyway
+ */
+inline bool numa_bind(void *p, size_t size, int node)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+	unsigned long mask[16] = { };
+	if (node < 0 || node >= (int)(sizeof(mask) * 8))
+		return false;
+	mask[node / (sizeof(long) * 8)] = 1UL << (node % (sizeof(long) * 8));
+	const int mpol_preferred = 1;
+	return syscall(SYS_mbind, p, size, mpol_preferred, mask, sizeof(mask) * 8 + 1, 0) == 0;
+#else
+	(void)p;
+	(void)size;
+	(void)node;
+	return false;
+#endif
+}
+
+/**
+ * \brief Allocator which places every allocation of at least TUPLE_VECTOR_HUGE_PAGE bytes on one
+ *		NUMA node (see numa_bind()), backed by transparent huge pages like huge_page_allocator.
+ *		Smaller allocations come from operator new. This is what keeps every replica of a
+ *		numa_tuple_vector in the memory of the node whose threads read it.
+ * \tparam T element type
+ */
+template<typename T>
+class numa_allocator {
+public:
+	typedef T value_type;
+
+	/// allocator for the given node, -1 leaves the placement to the kernel
+	explicit numa_allocator(int node = -1) noexcept : m_node(node) { }
+	template<typename U>
+	numa_allocator(const numa_allocator<U> &x) noexcept : m_node(x.node()) { }
+
+	T *allocate(size_t n) {
+		const size_t size = n * sizeof(T);
+		if (size < TUPLE_VECTOR_HUGE_PAGE)
+			return (T *)::operator new(size);
+		void *p = huge_page_map(_round(size), huge_page_mode::madvise);
+		if (!p)
+			throw std::bad_alloc();
+		if (m_node >= 0)
+			numa_bind(p, _round(size), m_node);
+		return (T *)p;
+	}
+
+	void deallocate(T *p, size_t n) noexcept {
+		const size_t size = n * sizeof(T);
+		if (size < TUPLE_VECTOR_HUGE_PAGE)
+			::operator delete(p);
+		else
+			huge_page_unmap(p, _round(size));
+	}
+
+	int node() const noexcept { return m_node; }
+
+	template<typename U>
+	bool operator==(const numa_allocator<U> &x) const noexcept { return m_node == x.node(); }
+	template<typename U>
+	bool operator!=(const numa_allocator<U> &x) const noexcept { return m_node != x.node(); }
+
+private:
+	static size_t _round(size_t size) {
+		return (size + TUPLE_VECTOR_HUGE_PAGE - 1) / TUPLE_VECTOR_HUGE_PAGE * TUPLE_VECTOR_HUGE_PAGE;
+	}
+
+	int m_node;
+};
+
+#endif /* __allocators_h */
@@ -0,0 +1,109 @@
+/**
+ * \file	asof_join.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __asof_join_h
+#define __asof_join_h
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+
+#include "tuple_vector.h"
+
+/// which element of the right series an as-of join matches with a key of the left series
+enum class asof_direction {
+	backward,	///< the last element with a key not greater than the left key
+	forward,	///< the first element with a key not less than the left key
+	nearest		///< whichever of the two is closer, backward on a tie
+};
+
+/**
+ * \brief advance from first to the first element in [first, last) for which pred is false,
+ *		pred must be true for a prefix of the range only
+ *		The search gallops with exponentially growing steps from first, so skipping d elements
+ *		costs O(log d): an as-of join of n keys against m elements costs O(n log(m/n)), which is
+ *		never worse than the O(n+m) of a plain merge and much better when n is small.
+ */
+template<typename It, typename Pred>
+inline It asof_advance(It first, It last, Pred pred)
+{
+	if (first == last || !pred(*first))
+		return first;
+	// pred(*lo) is always true
+	It lo = first;
+	for (typename std::iterator_traits<It>::difference_type step = 1; last - lo > step; step *= 2) {
+		It probe = lo + step;
+		if (!pred(*probe))
+			return std::partition_point(lo + 1, probe, pred);
+		lo = probe;
+	}
+	return std::partition_point(lo + 1, last, pred);
+}
+
+/**
+ * \brief as-of join of two timeseries in a single merge pass
+ *		For every element of left, the index of the matching element of right is written to out
+ *		(see asof_direction), or right.size() if there is none or it is further away than
+ *		tolerance. Both series are walked once from front to back, which is what makes this
+ *		cheaper than a lower_bound() into right for every key of left.
+ * \param left series whose keys are looked up, e.g. trades
+ * \param right series that is searched, e.g. quotes
+ * \param out receives one index into right per element of left
+ * \param dir which element of right matches
+ * \param tolerance maximum distance between the keys of matching elements in key<K> units
+ * \tparam L,R tuple_vector, columnar_tuple_vector, mapped_tuple_vector or anything else with
+ *		random access iterators to elements with a "first" key, sorted by key
+ * \return out after the last written index
+ */
+template<typename L, typename R, typename OutputIt>
+OutputIt asof_join(const L &left, const R &right, OutputIt out, asof_direction dir = asof_direction::backward,
+	double tolerance = std::numeric_limits<double>::infinity())
+{
+	typedef typename std::decay<decltype(left.begin()->first)>::type K;
+	const ::key<K> kf;
+	const size_t none = right.size();
+	const auto rfirst = right.begin(), rlast = right.end();
+	// first element of right not less than the current left key
+	auto r = rfirst;
+	for (auto l = left.begin(); l != left.end(); ++l) {
+		const K &k = l->first;
+		r = asof_advance(r, rlast, [&k](const decltype(*r) &e) { return e.first < k; });
+		bool exact = r != rlast && r->first == k;
+		// candidates: the last element before k and the first element not less than k
+		bool has_back = exact || r != rfirst, has_fwd = r != rlast;
+		double back_dist = 0, fwd_dist = 0;
+		if (!exact) {
+			if (has_back)
+				back_dist = kf(k) - kf((r - 1)->first);
+			if (has_fwd)
+				fwd_dist = kf(r->first) - kf(k);
+		}
+		size_t idx = none;
+		switch (dir) {
+		case asof_direction::backward:
+			if (has_back && back_dist <= tolerance)
+				idx = (exact ? r : r - 1) - rfirst;
+			break;
+		case asof_direction::forward:
+			if (has_fwd && fwd_dist <= tolerance)
+				idx = r - rfirst;
+			break;
+		case asof_direction::nearest:
+			if (exact)
+				idx = r - rfirst;
+			else if (has_back && back_dist <= tolerance && (!has_fwd || back_dist <= fwd_dist))
+				idx = r - 1 - rfirst;
+			else if (has_fwd && fwd_dist <= tolerance)
+				idx = r - rfirst;
+			break;
+		}
+		*out++ = idx;
+	}
+	return out;
+}
+
+#endif /* __asof_join_h */
@@ -0,0 +1,746 @@
+/**
+ * \file	bench.cc
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ * \brief	Benchmark suite for the search paths of tuple_vector and columnar_tuple_vector.
+ *		Unlike perf.cc, every lookup is timed on its own, so besides the mean the output has
+ *		per-lookup latency percentiles, and the keys come from realistic generators instead of
+ *		a dense counter. The output is a TSV file with the columns mkplots.r expects plus some
+ *		extra ones, so regressions can be plotted and compared.
+ *
+ *		With -b it measures how bulk_load() scales with the number of threads instead, with -a
+ *		the latency of every single emplace_back() into a vector-backed and a chunked series,
+ *		with -r the latencies of an appending writer and of concurrent readers, locking a
+ *		mutex vs. taking snapshots, with -n the find() latency of threads pinned to each NUMA
+ *		node in every replica of a numa_tuple_vector, i.e. local vs. remote memory.
+ *
+ *		usage: bench [-s start size] [-e end size] [-t size step] [-q queries] [-c cold queries]
+ *			[-l eviction buffer MB] [-f tick file] [-o output file] [-b] [-a] [-r] [-n]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <getopt.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "tuple_vector.h"
+#include "columnar_tuple_vector.h"
+#include "chunked_tuple_vector.h"
+#include "snapshot_tuple_vector.h"
+#include "numa_tuple_vector.h"
+#include "bulk_load.h"
+
+using namespace std;
+
+/// nanoseconds since the epoch, interpolated exactly by tuple_vector
+typedef int64_t K;
+
+/**
+ * \brief cache-miss and branch-miss counters of the calling thread via perf_event_open(2)
+ *		Both counters are read as one group. If the kernel does not allow it (e.g. because of
+ *		/proc/sys/kernel/perf_event_paranoid, or in a container) or this is not Linux,
+ *		available() is false and the counts are reported as NA.
+ */
+class hw_counters {
+public:
+	hw_counters() {
+#ifdef __linux__
+		m_fd[0] = _open(PERF_COUNT_HW_CACHE_MISSES, -1);
+		if (m_fd[0] >= 0)
+			m_fd[1] = _open(PERF_COUNT_HW_BRANCH_MISSES, m_fd[0]);
+		if (m_fd[1] < 0 && m_fd[0] >= 0) {
+			close(m_fd[0]);
+			m_fd[0] = -1;
+		}
+#endif
+	}
+	~hw_counters() {
+#ifdef __linux__
+		for (int fd : m_fd)
+			if (fd >= 0)
+				close(fd);
+#endif
+	}
+	hw_counters(const hw_counters &) = delete;
+	hw_counters &operator=(const hw_counters &) = delete;
+
+	bool available() const { return m_fd[0] >= 0; }
+
+	/// set both counts to zero
+	void reset() {
+#ifdef __linux__
+		if (available())
+			ioctl(m_fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+#endif
+	}
+	/// start counting
+	void start() {
+#ifdef __linux__
+		if (available())
+			ioctl(m_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+	}
+	/// stop counting
+	void stop() {
+#ifdef __linux__
+		if (available())
+			ioctl(m_fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+#endif
+	}
+	/// read the counts since the last reset(), false if there are none
+	bool read(uint64_t &cache_misses, uint64_t &branch_misses) const {
+#ifdef __linux__
+		// PERF_FORMAT_GROUP layout: number of counters followed by their values
+		uint64_t buf[3];
+		if (available() && ::read(m_fd[0], buf, sizeof(buf)) == (ssize_t)sizeof(buf) && buf[0] == 2) {
+			cache_misses = buf[1];
+			branch_misses = buf[2];
+			return true;
+		}
+#endif
+		cache_misses = branch_misses = 0;
+		return false;
+	}
+
+private:
+#ifdef __linux__
+	static int _open(uint64_t config, int group) {
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = config;
+		attr.disabled = group < 0;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP;
+		return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+	}
+#endif
+	int m_fd[2] = { -1, -1 };
+};
+
+/// key distributions produced by make_keys()
+enum distribution {
+	uniform,	///< one key every microsecond
+	gaps,		///< exponentially distributed gaps with a mean of one microsecond
+	sessions,	///< 8 hour trading sessions with random gaps, separated by 16 hour overnight gaps
+	bursts,		///< bursts of 1000 keys 10ns apart alternating with quiet periods of 100 keys 1ms apart
+	replay		///< real tick timestamps read from a file
+};
+
+static const char *distribution_name[] = { "uniform", "gaps", "sessions", "bursts", "replay" };
+
+/// query patterns produced by make_queries()
+enum pattern {
+	sequential_queries,	///< consecutive keys from a random start
+	random_queries,		///< uniformly chosen keys
+	hotset_queries		///< 90% of the keys from a random 1% of the series, the rest uniformly chosen
+};
+
+static const char *pattern_name[] = { "sequential", "random", "hotset" };
+
+/**
+ * \brief read tick timestamps, the first integer on every line, e.g. nanoseconds since the
+ *		epoch, sorted with duplicates removed
+ */
+vector<K> read_ticks(const string &path)
+{
+	vector<K> ticks;
+	ifstream is(path);
+	if (!is)
+		throw runtime_error("cannot open " + path);
+	string line;
+	while (getline(is, line)) {
+		char *end;
+		long long t = strtoll(line.c_str(), &end, 10);
+		if (end != line.c_str())
+			ticks.push_back(t);
+	}
+	sort(ticks.begin(), ticks.end());
+	ticks.erase(unique(ticks.begin(), ticks.end()), ticks.end());
+	return ticks;
+}
+
+/**
+ * \brief create sz strictly increasing keys with the given distribution, starting at about
+ *		1.7e18 (nanoseconds since the epoch in 2023)
+ * \param ticks timestamps for the replay distribution, the first sz are used
+ */
+vector<K> make_keys(size_t sz, distribution dist, const vector<K> &ticks, mt19937_64 &rng)
+{
+	if (dist == replay)
+		return vector<K>(ticks.begin(), ticks.begin() + min(sz, ticks.size()));
+	const K us = 1000, hour = 3600000000000LL;
+	exponential_distribution<double> gap(1.0 / us);
+	vector<K> keys;
+	keys.reserve(sz);
+	K t = 1700000000000000000LL, session_end = t + 8 * hour;
+	for (size_t n = 0; n < sz; n++) {
+		switch (dist) {
+		case uniform:
+			t += us;
+			break;
+		case gaps:
+			t += 1 + (K)gap(rng);
+			break;
+		case sessions:
+			t += 1 + (K)gap(rng);
+			if (t > session_end) {
+				t += 16 * hour;
+				session_end = t + 8 * hour;
+			}
+			break;
+		case bursts:
+			t += n % 1100 < 1000 ? 10 : 1000 * us;
+			break;
+		default:
+			break;
+		}
+		keys.push_back(t);
+	}
+	return keys;
+}
+
+/// create q lookup keys from keys with the given pattern
+vector<K> make_queries(const vector<K> &keys, size_t q, pattern pat, mt19937_64 &rng)
+{
+	vector<K> queries;
+	queries.reserve(q);
+	uniform_int_distribution<size_t> any(0, keys.size() - 1);
+	size_t hot = max<size_t>(keys.size() / 100, 1), hot_start = any(rng) % (keys.size() - hot + 1);
+	size_t pos = any(rng);
+	for (size_t i = 0; i < q; i++) {
+		switch (pat) {
+		case sequential_queries:
+			queries.push_back(keys[pos++ % keys.size()]);
+			break;
+		case random_queries:
+			queries.push_back(keys[any(rng)]);
+			break;
+		case hotset_queries:
+			queries.push_back(rng() % 10 ? keys[hot_start + rng() % hot] : keys[any(rng)]);
+			break;
+		}
+	}
+	return queries;
+}
+
+/// touches a buffer larger than the last level cache to evict everything else from the caches
+class evictor {
+public:
+	explicit evictor(size_t bytes) : m_buf(bytes) { }
+	void operator()() {
+		for (size_t i = 0; i < m_buf.size(); i += 64)
+			m_buf[i]++;
+	}
+private:
+	vector<unsigned char> m_buf;
+};
+
+/// per-lookup latency statistics in nanoseconds plus hardware counters per lookup
+struct result {
+	double runtime, min, max, avg, var, dev, p50, p99, p999;
+	bool counted;
+	double cache_misses, branch_misses;
+};
+
+/// percentile p of the sorted latencies
+static double percentile(const vector<double> &sorted, double p)
+{
+	return sorted[min(sorted.size() - 1, (size_t)(p * sorted.size()))];
+}
+
+/// cost of the two clock reads around every lookup, subtracted from the latencies
+static double timer_overhead()
+{
+	vector<double> d(10000);
+	for (auto &x : d) {
+		auto t0 = chrono::steady_clock::now();
+		auto t1 = chrono::steady_clock::now();
+		x = chrono::duration<double, nano>(t1 - t0).count();
+	}
+	sort(d.begin(), d.end());
+	return d[d.size() / 2];
+}
+
+/**
+ * \brief runtime (us), min, max, avg, var, dev and percentiles (ns) of the latencies of n
+ *		operations, plus the hardware counters per operation, sorts lat
+ */
+static result summarize(vector<double> &lat, hw_counters &hw)
+{
+	const size_t n = lat.size();
+	result r;
+	uint64_t cm, bm;
+	r.counted = hw.read(cm, bm);
+	r.cache_misses = (double)cm / n;
+	r.branch_misses = (double)bm / n;
+	r.runtime = r.avg = r.var = 0;
+	for (double x : lat)
+		r.runtime += x;
+	r.avg = r.runtime / n;
+	for (double x : lat)
+		r.var += (x - r.avg) * (x - r.avg);
+	r.var /= n;
+	r.dev = sqrt(r.var);
+	r.runtime /= 1000;
+	sort(lat.begin(), lat.end());
+	r.min = lat.front();
+	r.max = lat.back();
+	r.p50 = percentile(lat, 0.5);
+	r.p99 = percentile(lat, 0.99);
+	r.p999 = percentile(lat, 0.999);
+	return r;
+}
+
+/// sum of all lookup results, so the lookups are not optimised away
+volatile double lookup_sink;
+
+/**
+ * \brief time every lookup of queries on its own
+ *		A warm run first does all lookups once untimed, so the caches and the adaptive search
+ *		state are warmed up. A cold run evicts all caches before every lookup and only uses
+ *		the first cold_queries keys.
+ * \param lookup functor doing one lookup, returning something to sum up so it is not optimised away
+ */
+template<typename F>
+result measure(const vector<K> &queries, size_t cold_queries, bool cold, F lookup, evictor &evict, hw_counters &hw, double overhead)
+{
+	const size_t n = cold ? min(cold_queries, queries.size()) : queries.size();
+	vector<double> lat(n);
+	double sum = 0;
+	if (!cold)
+		for (const K &k : queries)
+			sum += lookup(k);
+	hw.reset();
+	if (!cold)
+		hw.start();
+	for (size_t i = 0; i < n; i++) {
+		if (cold) {
+			evict();
+			hw.start();
+		}
+		auto t0 = chrono::steady_clock::now();
+		sum += lookup(queries[i]);
+		auto t1 = chrono::steady_clock::now();
+		if (cold)
+			hw.stop();
+		lat[i] = max(0.0, chrono::duration<double, nano>(t1 - t0).count() - overhead);
+	}
+	hw.stop();
+	lookup_sink = sum;
+	return summarize(lat, hw);
+}
+
+/**
+ * \brief write one result as a line in the format read by mkplots.r: test, size, container,
+ *		runtime (us), min, max, avg, var, dev (ns per lookup), followed by the latency
+ *		percentiles and hardware counters per lookup (NA if not available)
+ */
+void write_result(ostream &os, const string &test, size_t sz, const string &container, const result &r)
+{
+	os << test << '\t' << sz << '\t' << container << '\t' << (uint64_t)r.runtime
+		<< fixed << setprecision(5)
+		<< '\t' << r.min << '\t' << r.max << '\t' << r.avg << '\t' << r.var << '\t' << r.dev
+		<< '\t' << r.p50 << '\t' << r.p99 << '\t' << r.p999;
+	if (r.counted)
+		os << '\t' << r.cache_misses << '\t' << r.branch_misses << endl;
+	else
+		os << "\tNA\tNA" << endl;
+}
+
+/**
+ * \brief time bulk_load() of sz elements from 4 unsorted feeds with about 1% duplicate keys
+ *		with 1, 2, 4, ... threads up to the number of cores. Every thread count is run runs
+ *		times, min/max/avg/var/dev are the times per element in ns over these runs, p50 is
+ *		the median and p99/p999 the slowest run.
+ */
+void bulk_scaling(ostream &os, size_t sz, hw_counters &hw, int runs = 5)
+{
+	typedef pair<K, double> element;
+	mt19937_64 rng(sz);
+	vector<K> keys = make_keys(sz, gaps, vector<K>(), rng);
+	for (size_t i = 0; i < sz / 100; i++)
+		keys[rng() % sz] = keys[rng() % sz];
+	shuffle(keys.begin(), keys.end(), rng);
+	vector<vector<element>> feeds(4);
+	for (size_t i = 0; i < sz; i++)
+		feeds[i % feeds.size()].emplace_back(keys[i], (double)i);
+	vector<pair<vector<element>::const_iterator, vector<element>::const_iterator>> ranges;
+	for (const auto &f : feeds)
+		ranges.emplace_back(f.cbegin(), f.cend());
+
+	const unsigned cores = max(1u, thread::hardware_concurrency());
+	for (unsigned threads = 1; ; threads = min(threads * 2, cores)) {
+		cout << "bulk_load with size " << sz << " and " << threads << " threads" << endl;
+		vector<double> per_element(runs);
+		hw.reset();
+		for (int r = 0; r < runs; r++) {
+			tuple_vector<K, double> tv;
+			hw.start();
+			auto t0 = chrono::steady_clock::now();
+			bulk_load(tv, ranges, duplicate_policy::keep_last, threads);
+			auto t1 = chrono::steady_clock::now();
+			hw.stop();
+			per_element[r] = chrono::duration<double, nano>(t1 - t0).count() / sz;
+		}
+		result res;
+		uint64_t cm, bm;
+		res.counted = hw.read(cm, bm);
+		res.cache_misses = (double)cm / sz / runs;
+		res.branch_misses = (double)bm / sz / runs;
+		res.runtime = res.avg = res.var = 0;
+		for (double x : per_element)
+			res.avg += x / runs;
+		for (double x : per_element)
+			res.var += (x - res.avg) * (x - res.avg) / runs;
+		res.dev = sqrt(res.var);
+		res.runtime = res.avg * sz * runs / 1000;
+		sort(per_element.begin(), per_element.end());
+		res.min = per_element.front();
+		res.max = res.p99 = res.p999 = per_element.back();
+		res.p50 = percentile(per_element, 0.5);
+		write_result(os, "bulk_load", sz, "threads " + to_string(threads), res);
+		if (threads == cores)
+			break;
+	}
+}
+
+/**
+ * \brief time every single emplace_back() while building a series of sz elements from scratch,
+ *		vector-backed (tuple_vector) vs. chunked (chunked_tuple_vector). The tail latencies
+ *		(p99.9 and max) show the copies a std::vector makes whenever it outgrows its capacity.
+ */
+void append_latency(ostream &os, size_t sz, hw_counters &hw, double overhead)
+{
+	mt19937_64 rng(sz);
+	vector<K> keys = make_keys(sz, uniform, vector<K>(), rng);
+	vector<double> lat(keys.size());
+	auto run = [&](const string &container, auto &c) {
+		cout << "append with size " << keys.size() << " into " << container << endl;
+		hw.reset();
+		hw.start();
+		for (size_t i = 0; i < keys.size(); i++) {
+			auto t0 = chrono::steady_clock::now();
+			c.emplace_back(keys[i], (double)i);
+			auto t1 = chrono::steady_clock::now();
+			lat[i] = max(0.0, chrono::duration<double, nano>(t1 - t0).count() - overhead);
+		}
+		hw.stop();
+		write_result(os, "append", keys.size(), container, summarize(lat, hw));
+	};
+	{
+		tuple_vector<K, double> tv;
+		run("tuple", tv);
+	}
+	{
+		chunked_tuple_vector<K, double> chv;
+		run("chunked", chv);
+	}
+}
+
+/**
+ * \brief time every emplace_back() of the second half of sz elements while n_readers threads
+ *		look up random keys of the first half, n_queries in total, each lookup timed on its
+ *		own. In the "mutex" runs writer and readers lock a mutex around every operation, in
+ *		the "snapshot" runs the writer appends to a snapshot_tuple_vector and the readers take
+ *		a new snapshot for every lookup. The hardware counters only cover the writer thread,
+ *		the reader lines have none. The reader throughput goes to stdout.
+ */
+void contention(ostream &os, size_t sz, size_t n_queries, hw_counters &hw, double overhead, size_t n_readers = 3)
+{
+	mt19937_64 rng(sz);
+	vector<K> keys = make_keys(sz, uniform, vector<K>(), rng);
+	const size_t half = keys.size() / 2, per_reader = n_queries / n_readers;
+	vector<K> queries(per_reader * n_readers);
+	uniform_int_distribution<size_t> pick(0, half - 1);
+	for (auto &q : queries)
+		q = keys[pick(rng)];
+	vector<double> writer_lat(keys.size() - half), reader_lat(queries.size());
+
+	// append is called for every element of the second half, find for a reader's query
+	auto run = [&](const string &container, auto append, auto make_reader) {
+		cout << "contention with size " << keys.size() << " and " << n_readers << " readers on " << container << endl;
+		vector<thread> threads;
+		for (size_t t = 0; t < n_readers; t++)
+			threads.emplace_back([&,t]() {
+				auto find = make_reader();
+				double sum = 0;
+				for (size_t i = t * per_reader; i < (t + 1) * per_reader; i++) {
+					auto t0 = chrono::steady_clock::now();
+					sum += find(queries[i]);
+					auto t1 = chrono::steady_clock::now();
+					reader_lat[i] = max(0.0, chrono::duration<double, nano>(t1 - t0).count() - overhead);
+				}
+				lookup_sink = sum;
+			});
+		auto start = chrono::steady_clock::now();
+		hw.reset();
+		hw.start();
+		for (size_t i = half; i < keys.size(); i++) {
+			auto t0 = chrono::steady_clock::now();
+			append(keys[i], (double)i);
+			auto t1 = chrono::steady_clock::now();
+			writer_lat[i - half] = max(0.0, chrono::duration<double, nano>(t1 - t0).count() - overhead);
+		}
+		hw.stop();
+		for (auto &t : threads)
+			t.join();
+		const double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		cout << "  " << (uint64_t)(queries.size() / secs) << " lookups/s" << endl;
+		write_result(os, "contended_append", keys.size(), container, summarize(writer_lat, hw));
+		result r = summarize(reader_lat, hw);
+		r.counted = false;
+		write_result(os, "contended_find", keys.size(), container, r);
+	};
+	{
+		tuple_vector<K, double> tv;
+		mutex mtx;
+		for (size_t i = 0; i < half; i++)
+			tv.emplace_back(keys[i], (double)i);
+		run("mutex",
+			[&](const K &k, double v) { lock_guard<mutex> guard(mtx); tv.emplace_back(k, v); },
+			[&]() {
+				return [&tv,&mtx,ctx = search_context()](const K &k) mutable {
+					lock_guard<mutex> guard(mtx);
+					return tv.find(k, ctx)->second;
+				};
+			});
+	}
+	{
+		snapshot_tuple_vector<K, double> stv(half);
+		for (size_t i = 0; i < half; i++)
+			stv.emplace_back(keys[i], (double)i);
+		run("snapshot",
+			[&](const K &k, double v) { stv.emplace_back(k, v); },
+			[&]() {
+				return [r = make_shared<snapshot_tuple_vector<K, double>::reader>(stv)](const K &k) {
+					auto snap = r->snapshot();
+					return snap.find(k)->second;
+				};
+			});
+	}
+}
+
+/**
+ * \brief time random find()s of a thread pinned to each NUMA node in each replica of a
+ *		numa_tuple_vector of sz elements, one line per node and replica, so the local lookups
+ *		can be compared with the remote ones. On a single node machine there is only the local
+ *		line. The hardware counters are those of the pinned thread.
+ */
+void numa_latency(ostream &os, size_t sz, size_t n_queries, evictor &evict, double overhead)
+{
+	mt19937_64 rng(sz);
+	vector<K> keys = make_keys(sz, uniform, vector<K>(), rng);
+	numa_tuple_vector<K, double> nv;
+	nv.reserve(keys.size());
+	for (size_t i = 0; i < keys.size(); i++)
+		nv.emplace_back(keys[i], (double)i);
+	vector<K> queries(n_queries);
+	uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+	for (auto &q : queries)
+		q = keys[pick(rng)];
+
+	for (int node : numa_nodes()) {
+		for (size_t r = 0; r < nv.replicas(); r++) {
+			const string container = "node " + to_string(node) + " replica " + to_string(nv.node(r))
+				+ (nv.node(r) == node ? " local" : " remote");
+			cout << "numa find with size " << keys.size() << " from " << container << endl;
+			result res;
+			thread t([&]() {
+				if (!numa_pin_thread(node))
+					cerr << "could not pin to node " << node << endl;
+				hw_counters hw;
+				const auto &tv = nv.replica(r);
+				search_context ctx;
+				res = measure(queries, 0, false, [&tv,&ctx](const K &k) { return tv.find(k, ctx)->second; }, evict, hw, overhead);
+			});
+			t.join();
+			write_result(os, "numa_find", keys.size(), container, res);
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	size_t start_sz = 1000000, end_sz = 1000000, sz_step = 1000000, n_queries = 1000000, cold_queries = 200;
+	size_t evict_mb = 64;
+	string tick_file, out_file = "bench.txt";
+	bool bulk = false, append = false, contended = false, numa = false;
+	int opt;
+	while ((opt = getopt(argc, argv, "s:e:t:q:c:l:f:o:barn")) != -1) {
+		switch (opt) {
+		case 's': start_sz = strtoull(optarg, nullptr, 10); break;
+		case 'e': end_sz = strtoull(optarg, nullptr, 10); break;
+		case 't': sz_step = strtoull(optarg, nullptr, 10); break;
+		case 'q': n_queries = strtoull(optarg, nullptr, 10); break;
+		case 'c': cold_queries = strtoull(optarg, nullptr, 10); break;
+		case 'l': evict_mb = strtoull(optarg, nullptr, 10); break;
+		case 'f': tick_file = optarg; break;
+		case 'o': out_file = optarg; break;
+		case 'b': bulk = true; break;
+		case 'a': append = true; break;
+		case 'r': contended = true; break;
+		case 'n': numa = true; break;
+		default:
+			cerr << "usage: " << argv[0] << " [-s start size] [-e end size] [-t size step] [-q queries]"
+				" [-c cold queries] [-l eviction buffer MB] [-f tick file] [-o output file] [-b] [-a] [-r] [-n]" << endl;
+			return 1;
+		}
+	}
+	if (end_sz < start_sz)
+		end_sz = start_sz;
+	if (!sz_step)
+		sz_step = 1;
+
+	vector<K> ticks;
+	if (!tick_file.empty())
+		ticks = read_ticks(tick_file);
+
+	hw_counters hw;
+	evictor evict(evict_mb << 20);
+	const double overhead = timer_overhead();
+	cout << "timer overhead " << overhead << "ns, hardware counters "
+		<< (hw.available() ? "available" : "not available") << endl;
+
+	ofstream ofs(out_file);
+	ofs << "test" << '\t' << "size" << '\t' << "container" << '\t'
+		<< "runtime" << '\t' << "min" << '\t' << "max" << '\t'
+		<< "avg" << '\t' << "var" << '\t' << "dev" << '\t'
+		<< "p50" << '\t' << "p99" << '\t' << "p999" << '\t'
+		<< "cache_misses" << '\t' << "branch_misses" << endl;
+
+	if (bulk) {
+		for (size_t sz = start_sz; sz <= end_sz; sz += sz_step)
+			bulk_scaling(ofs, sz, hw);
+		return 0;
+	}
+	if (append) {
+		for (size_t sz = start_sz; sz <= end_sz; sz += sz_step)
+			append_latency(ofs, sz, hw, overhead);
+		return 0;
+	}
+	if (contended) {
+		for (size_t sz = start_sz; sz <= end_sz; sz += sz_step)
+			contention(ofs, sz, n_queries, hw, overhead);
+		return 0;
+	}
+	if (numa) {
+		for (size_t sz = start_sz; sz <= end_sz; sz += sz_step)
+			numa_latency(ofs, sz, n_queries, evict, overhead);
+		return 0;
+	}
+
+	for (size_t sz = start_sz; sz <= end_sz; sz += sz_step) {
+		for (int d = uniform; d <= replay; d++) {
+			if (d == replay && ticks.empty())
+				continue;
+			mt19937_64 rng(sz * 5 + d);
+			vector<K> keys = make_keys(sz, (distribution)d, ticks, rng);
+			if (keys.empty())
+				continue;
+
+			tuple_vector<K, double> tv;
+			tuple_vector<K, double> itv;
+			columnar_tuple_vector<K, double> ctv;
+			chunked_tuple_vector<K, double> chv;
+			map<K, double> map;
+			for (size_t i = 0; i < keys.size(); i++) {
+				tv.emplace_back(keys[i], (double)i);
+				itv.emplace_back(keys[i], (double)i);
+				ctv.emplace_back(keys[i], (double)i);
+				chv.emplace_back(keys[i], (double)i);
+				map.emplace(keys[i], (double)i);
+			}
+			itv.build_index();
+
+			for (int p = sequential_queries; p <= hotset_queries; p++) {
+				vector<K> queries = make_queries(keys, n_queries, (pattern)p, rng);
+				// lower_bound() looks up keys which are not in the series
+				vector<K> between(queries);
+				for (K &k : between)
+					k -= 1;
+				for (int cold = 0; cold <= 1; cold++) {
+					const string suffix = string("_") + distribution_name[d] + "_" + pattern_name[p] + (cold ? "_cold" : "_warm");
+					cout << suffix.substr(1) << " with size " << keys.size() << endl;
+
+					auto run = [&](const string &test, const string &container, const vector<K> &q, auto lookup) {
+						write_result(ofs, test + suffix, keys.size(), container,
+							measure(q, cold_queries, cold, lookup, evict, hw, overhead));
+					};
+					run("find", "map", queries, [&map](const K &k) {
+						auto it = map.find(k);
+						if (it == map.end()) abort();
+						return it->second;
+					});
+					run("find", "tuple", queries, [&tv](const K &k) {
+						auto it = tv.find(k);
+						if (it == tv.end()) abort();
+						return it->second;
+					});
+					run("find", "columnar", queries, [&ctv](const K &k) {
+						auto it = ctv.find(k);
+						if (it == ctv.end()) abort();
+						return (*it).second;
+					});
+					run("find", "chunked", queries, [&chv](const K &k) {
+						auto it = chv.find(k);
+						if (it == chv.end()) abort();
+						return it->second;
+					});
+					run("find", "tuple index", queries, [&itv](const K &k) {
+						auto it = itv.find(k);
+						if (it == itv.end()) abort();
+						return it->second;
+					});
+					run("lower_bound", "map", between, [&map](const K &k) {
+						auto it = map.lower_bound(k);
+						if (it == map.end()) abort();
+						return it->second;
+					});
+					run("lower_bound", "tuple", between, [&tv](const K &k) {
+						auto it = tv.lower_bound(k);
+						if (it == tv.end()) abort();
+						return it->second;
+					});
+					run("lower_bound", "columnar", between, [&ctv](const K &k) {
+						auto it = ctv.lower_bound(k);
+						if (it == ctv.end()) abort();
+						return (*it).second;
+					});
+					run("lower_bound", "chunked", between, [&chv](const K &k) {
+						auto it = chv.lower_bound(k);
+						if (it == chv.end()) abort();
+						return it->second;
+					});
+					run("lower_bound", "tuple index", between, [&itv](const K &k) {
+						auto it = itv.lower_bound(k);
+						if (it == itv.end()) abort();
+						return it->second;
+					});
+				}
+			}
+		}
+	}
+}
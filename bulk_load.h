@@ -0,0 +1,226 @@
+/**
+ * \file	bulk_load.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __bulk_load_h
+#define __bulk_load_h
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "tuple_vector.h"
+
+/// minimum number of elements per thread of bulk_load() and find_unordered()
+#ifndef TUPLE_VECTOR_BULK_GRAIN
+#define TUPLE_VECTOR_BULK_GRAIN 65536
+#endif
+
+/// what bulk_load() does with elements that have the same key
+enum class duplicate_policy {
+	keep_first,	///< keep the element that comes first in the input, drop the others
+	keep_last,	///< keep the element that comes last in the input, drop the others
+	error		///< throw std::runtime_error
+};
+
+/**
+ * \brief run fn(t) for t = 0 .. threads - 1, fn(0) on the calling thread and the others on
+ *		threads of their own
+ */
+template<typename F>
+inline void bulk_parallel(unsigned threads, F fn)
+{
+	std::vector<std::thread> pool;
+	for (unsigned t = 1; t < threads; ++t)
+		pool.emplace_back(fn, t);
+	fn(0);
+	for (auto &th : pool)
+		th.join();
+}
+
+/// number of threads to use for n elements, at most threads (0: one per core)
+inline unsigned bulk_threads(size_t n, unsigned threads)
+{
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	return (unsigned)std::max<size_t>(1, std::min<size_t>(threads, n / TUPLE_VECTOR_BULK_GRAIN));
+}
+
+/**
+ * \brief parallel check that the keys of [first, last) are strictly increasing
+ *		Every thread checks one slice plus the first element of the next slice.
+ * \param threads number of threads, 0 for one per core
+ * \return index of the first element whose key is not greater than the key before it,
+ *		or last - first if the keys are strictly increasing
+ */
+template<typename RandomIt>
+size_t find_unordered(RandomIt first, RandomIt last, unsigned threads = 0)
+{
+	const size_t n = last - first;
+	const unsigned nt = bulk_threads(n, threads);
+	std::vector<size_t> bad(nt, n);
+	bulk_parallel(nt, [&](unsigned t) {
+		size_t b = n * t / nt, e = std::min(n, n * (t + 1) / nt + 1);
+		for (size_t i = b + 1; i < e; ++i)
+			if (!(first[i - 1].first < first[i].first)) {
+				bad[t] = i;
+				return;
+			}
+	});
+	return *std::min_element(bad.begin(), bad.end());
+}
+
+/**
+ * \brief build a tuple_vector from one or more unsorted ranges of std::pair<K,V>, e.g. the
+ *		ticks of several feeds, using several threads
+ *		1. all ranges are copied into one buffer, each thread copying its share
+ *		2. a parallel check finds out if the result is already strictly increasing, e.g. a
+ *		   single presorted source, in which case we are done
+ *		3. otherwise the buffer is cut into one chunk per thread and each chunk is stable
+ *		   sorted by key
+ *		4. the key space is split into one part per thread using keys sampled from the sorted
+ *		   chunks, and every thread does a k-way merge of its part of all chunks. All elements
+ *		   with the same key end up in the same part, so the duplicate policy is applied by
+ *		   each thread on its own while merging.
+ *		5. the parts are moved next to each other into the final container
+ *		Equal keys are kept in input order (ranges in the given order, each range front to
+ *		back), which is what keep_first and keep_last refer to.
+ * \param out container to fill, its previous contents are replaced
+ * \param ranges pairs of iterators [first, last) to the input ranges
+ * \param policy what to do with elements with the same key
+ * \param threads number of threads, 0 for one per core
+ * \throw std::runtime_error if policy is duplicate_policy::error and there are duplicate keys
+ */
+template<typename K, typename V, typename Stats, typename Allocator, typename It>
+void bulk_load(tuple_vector<K,V,Stats,Allocator> &out, const std::vector<std::pair<It,It>> &ranges,
+	duplicate_policy policy = duplicate_policy::keep_last, unsigned threads = 0)
+{
+	typedef std::pair<K,V> value_type;
+	// the buffers use the allocator of out, so the result can be moved into it at the end
+	typedef std::vector<value_type, Allocator> buffer;
+	typedef typename buffer::iterator buf_it;
+
+	// 1. concatenate all ranges, every thread copies a slice of the output
+	std::vector<size_t> start(ranges.size() + 1, 0);
+	for (size_t r = 0; r < ranges.size(); ++r)
+		start[r + 1] = start[r] + std::distance(ranges[r].first, ranges[r].second);
+	const size_t n = start.back();
+	const unsigned nt = bulk_threads(n, threads);
+	buffer buf(n, out.get_allocator());
+	bulk_parallel(nt, [&](unsigned t) {
+		size_t b = n * t / nt, e = n * (t + 1) / nt;
+		size_t r = std::upper_bound(start.begin(), start.end(), b) - start.begin() - 1;
+		for (; b < e; ++r) {
+			size_t cnt = std::min(e, start[r + 1]) - b;
+			std::copy_n(std::next(ranges[r].first, b - start[r]), cnt, buf.begin() + b);
+			b += cnt;
+		}
+	});
+
+	// 2. nothing to do for input which is already valid
+	if (find_unordered(buf.begin(), buf.end(), nt) == n) {
+		out = std::move(buf);
+		return;
+	}
+
+	// 3. stable sort one chunk per thread
+	const auto less = [](const value_type &a, const value_type &b) { return a.first < b.first; };
+	std::vector<std::pair<buf_it, buf_it>> chunks(nt);
+	bulk_parallel(nt, [&](unsigned t) {
+		chunks[t] = std::make_pair(buf.begin() + n * t / nt, buf.begin() + n * (t + 1) / nt);
+		std::stable_sort(chunks[t].first, chunks[t].second, less);
+	});
+
+	// 4. split the key space into one part per thread at keys sampled from all chunks
+	std::vector<K> samples;
+	const size_t per_chunk = 16 * nt;
+	for (auto &c : chunks)
+		for (size_t i = 1; i < per_chunk; ++i)
+			samples.push_back(c.first[(c.second - c.first) * i / per_chunk].first);
+	std::sort(samples.begin(), samples.end());
+	// bounds[t][c] is where part t begins in chunk c, the last row holds the chunk ends
+	std::vector<std::vector<buf_it>> bounds(nt + 1, std::vector<buf_it>(nt));
+	for (unsigned c = 0; c < nt; ++c) {
+		bounds[0][c] = chunks[c].first;
+		bounds[nt][c] = chunks[c].second;
+		for (unsigned t = 1; t < nt; ++t) {
+			const K &split = samples[samples.size() * t / nt];
+			bounds[t][c] = std::lower_bound(chunks[c].first, chunks[c].second, split,
+				[](const value_type &a, const K &b) { return a.first < b; });
+		}
+	}
+	std::vector<size_t> offset(nt + 1, 0), kept(nt, 0);
+	for (unsigned t = 0; t < nt; ++t) {
+		offset[t + 1] = offset[t];
+		for (unsigned c = 0; c < nt; ++c)
+			offset[t + 1] += bounds[t + 1][c] - bounds[t][c];
+	}
+	buffer merged(n, out.get_allocator());
+	std::vector<char> duplicate(nt, 0);
+	bulk_parallel(nt, [&](unsigned t) {
+		// k-way merge with a binary heap of chunk indices, ties go to the lower chunk which
+		// comes first in the input
+		std::vector<buf_it> pos(bounds[t]);
+		const std::vector<buf_it> &end = bounds[t + 1];
+		std::vector<unsigned> heap;
+		const auto after = [&pos](unsigned a, unsigned b) {
+			return pos[b]->first < pos[a]->first || (!(pos[a]->first < pos[b]->first) && b < a);
+		};
+		for (unsigned c = 0; c < nt; ++c)
+			if (pos[c] != end[c])
+				heap.push_back(c);
+		std::make_heap(heap.begin(), heap.end(), after);
+		buf_it dst = merged.begin() + offset[t], first = dst;
+		while (!heap.empty()) {
+			std::pop_heap(heap.begin(), heap.end(), after);
+			unsigned c = heap.back();
+			value_type &e = *pos[c];
+			if (dst != first && !((dst - 1)->first < e.first)) {
+				// same key as the element before
+				duplicate[t] = 1;
+				if (policy == duplicate_policy::keep_last)
+					dst[-1] = std::move(e);
+			} else {
+				*dst++ = std::move(e);
+			}
+			if (++pos[c] != end[c])
+				std::push_heap(heap.begin(), heap.end(), after);
+			else
+				heap.pop_back();
+		}
+		kept[t] = dst - first;
+	});
+	if (policy == duplicate_policy::error && std::find(duplicate.begin(), duplicate.end(), 1) != duplicate.end())
+		throw std::runtime_error("bulk_load: duplicate key");
+
+	// 5. close the gaps left by dropped duplicates
+	if (std::find(duplicate.begin(), duplicate.end(), 1) != duplicate.end()) {
+		std::vector<size_t> dst(nt + 1, 0);
+		for (unsigned t = 0; t < nt; ++t)
+			dst[t + 1] = dst[t] + kept[t];
+		buffer result(dst[nt], out.get_allocator());
+		bulk_parallel(nt, [&](unsigned t) {
+			std::move(merged.begin() + offset[t], merged.begin() + offset[t] + kept[t], result.begin() + dst[t]);
+		});
+		merged.swap(result);
+	}
+	out = std::move(merged);
+}
+
+/**
+ * \brief build a tuple_vector from a single unsorted range of std::pair<K,V>, see above
+ */
+template<typename K, typename V, typename Stats, typename Allocator, typename It>
+void bulk_load(tuple_vector<K,V,Stats,Allocator> &out, It first, It last,
+	duplicate_policy policy = duplicate_policy::keep_last, unsigned threads = 0)
+{
+	bulk_load(out, std::vector<std::pair<It,It>>(1, std::make_pair(first, last)), policy, threads);
+}
+
+#endif /* __bulk_load_h */
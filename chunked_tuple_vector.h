@@ -0,0 +1,377 @@
+/**
+ * \file	chunked_tuple_vector.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __chunked_tuple_vector_h
+#define __chunked_tuple_vector_h
+
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "tuple_vector.h"
+
+/// default number of elements per chunk of chunked_tuple_vector, must be a power of 2
+#ifndef TUPLE_VECTOR_CHUNK_SIZE
+#define TUPLE_VECTOR_CHUNK_SIZE 4096
+#endif
+
+/**
+ * \brief Random access iterator over the chunks of a chunked_tuple_vector. It holds the
+ *		container and an element index, so it stays valid while elements are appended.
+ * \tparam C the container type, const for a const_iterator
+ */
+template<typename C>
+class chunked_iterator {
+	typedef typename std::remove_const<C>::type container_type;
+public:
+	typedef std::random_access_iterator_tag									iterator_category;
+	typedef typename container_type::value_type								value_type;
+	typedef std::ptrdiff_t													difference_type;
+	typedef typename std::conditional<std::is_const<C>::value, const value_type, value_type>::type	&reference;
+	typedef typename std::conditional<std::is_const<C>::value, const value_type, value_type>::type	*pointer;
+
+	chunked_iterator() { }
+	chunked_iterator(C *c, size_t idx) : m_c(c), m_idx(idx) { }
+	/// allow conversion from iterator to const_iterator
+	template<typename D, typename = typename std::enable_if<std::is_same<const D, C>::value && !std::is_same<D, C>::value>::type>
+	chunked_iterator(const chunked_iterator<D> &it) : m_c(it.container()), m_idx(it.index()) { }
+
+	inline reference operator*() const { return (*m_c)[m_idx]; }
+	inline pointer operator->() const { return &(*m_c)[m_idx]; }
+	inline reference operator[](difference_type n) const { return (*m_c)[m_idx + n]; }
+
+	inline chunked_iterator &operator++() { ++m_idx; return *this; }
+	inline chunked_iterator &operator--() { --m_idx; return *this; }
+	inline chunked_iterator operator++(int) { chunked_iterator it(*this); ++m_idx; return it; }
+	inline chunked_iterator operator--(int) { chunked_iterator it(*this); --m_idx; return it; }
+	inline chunked_iterator &operator+=(difference_type n) { m_idx += n; return *this; }
+	inline chunked_iterator &operator-=(difference_type n) { m_idx -= n; return *this; }
+	inline chunked_iterator operator+(difference_type n) const { return chunked_iterator(m_c, m_idx + n); }
+	inline chunked_iterator operator-(difference_type n) const { return chunked_iterator(m_c, m_idx - n); }
+	inline difference_type operator-(const chunked_iterator &it) const { return (difference_type)m_idx - (difference_type)it.m_idx; }
+
+	inline bool operator==(const chunked_iterator &it) const { return m_idx == it.m_idx; }
+	inline bool operator!=(const chunked_iterator &it) const { return m_idx != it.m_idx; }
+	inline bool operator<(const chunked_iterator &it) const { return m_idx < it.m_idx; }
+	inline bool operator>(const chunked_iterator &it) const { return m_idx > it.m_idx; }
+	inline bool operator<=(const chunked_iterator &it) const { return m_idx <= it.m_idx; }
+	inline bool operator>=(const chunked_iterator &it) const { return m_idx >= it.m_idx; }
+
+	inline C *container() const { return m_c; }
+	inline size_t index() const { return m_idx; }
+
+private:
+	C *m_c = nullptr;
+	size_t m_idx = 0;
+};
+
+/**
+ * \brief Segmented variant of tuple_vector: the std::pair<K,V> elements live in fixed-size
+ *		chunks of Chunk elements which are never moved, plus a small directory holding the
+ *		first key of every chunk. Growing the series only ever allocates a new chunk, so an
+ *		emplace_back() never copies the existing elements the way a std::vector does when it
+ *		outgrows its capacity, and references and iterators stay valid while appending.
+ *		A lookup first runs the interpolation search over the chunk directory and then a
+ *		second one inside the chunk, each chunk keeping its own interpolation line.
+ *		Only appends and removing elements from the back are supported, the container does
+ *		not sort, so any data needs to be presorted.
+ * \tparam K A datetime type, e.g. time_t, boost::posix_time::ptime or similar.
+ * \tparam V A value type, can be whatever is appropriate for the use-case.
+ * \tparam Stats lookup statistics policy of the directory search, no_search_stats (default)
+ *		or search_stats
+ * \tparam Chunk number of elements per chunk, a power of 2
+ */
+template<typename K, typename V, typename Stats = no_search_stats, size_t Chunk = TUPLE_VECTOR_CHUNK_SIZE>
+class chunked_tuple_vector : public interpolation_search<K, K, Stats> {
+	static_assert(Chunk && (Chunk & (Chunk - 1)) == 0, "chunk size must be a power of 2");
+	typedef interpolation_search<K, K, Stats> search_type;
+	using search_type::m_ctx;
+public:
+	typedef std::pair<K,V>										value_type;
+	typedef value_type											&reference;
+	typedef const value_type									&const_reference;
+	typedef chunked_iterator<chunked_tuple_vector>				iterator;
+	typedef chunked_iterator<const chunked_tuple_vector>		const_iterator;
+	typedef size_t												size_type;
+	typedef typename search_type::context_type					context_type;
+	/// number of elements per chunk
+	static constexpr size_t chunk_size = Chunk;
+
+	chunked_tuple_vector() { }
+
+	chunked_tuple_vector(const chunked_tuple_vector &x) : search_type(x) {
+		_refresh();
+		for (auto &e : x)
+			emplace_back(e);
+	}
+
+	chunked_tuple_vector(chunked_tuple_vector &&x) : search_type(x), m_chunks(std::move(x.m_chunks)),
+		m_chunk_keys(std::move(x.m_chunk_keys)), m_size(x.m_size) {
+		x.m_size = 0;
+		_refresh();
+		x._refresh();
+	}
+
+	~chunked_tuple_vector() { }
+
+	inline chunked_tuple_vector &operator=(const chunked_tuple_vector &x) {
+		if (this != &x) {
+			search_type::operator=(x);
+			clear();
+			for (auto &e : x)
+				emplace_back(e);
+		}
+		return *this;
+	}
+	inline chunked_tuple_vector &operator=(chunked_tuple_vector &&x) {
+		m_chunks = std::move(x.m_chunks);
+		m_chunk_keys = std::move(x.m_chunk_keys);
+		m_size = x.m_size;
+		x.m_chunks.clear();
+		x.m_chunk_keys.clear();
+		x.m_size = 0;
+		search_type::operator=(x);
+		_refresh();
+		x._refresh();
+		return *this;
+	}
+
+	// Capacity
+	inline size_type size() const noexcept { return m_size; }
+	inline bool empty() const noexcept { return m_size == 0; }
+	inline size_type capacity() const noexcept { return m_chunks.size() * Chunk; }
+	/// number of chunks
+	inline size_type chunks() const noexcept { return m_chunks.size(); }
+	/// reserve room in the chunk directory for n elements, the chunks themselves are allocated when needed
+	inline void reserve(size_type n) {
+		m_chunks.reserve((n + Chunk - 1) / Chunk);
+		m_chunk_keys.reserve((n + Chunk - 1) / Chunk);
+		_refresh();
+	}
+
+	// Modifying operations.
+	void clear() noexcept {
+		m_chunks.clear();
+		m_chunk_keys.clear();
+		m_size = 0;
+		_refresh();
+	}
+	/// append an element, existing elements are never moved
+	template <typename... Args> inline void emplace_back(const K &key, Args&&... args) {
+		if ((m_size & (Chunk - 1)) == 0) {
+			// the last chunk is full, start a new one - it is only published with its key once
+			// the element is in place, so a throwing constructor leaves no empty chunk behind
+			std::unique_ptr<chunk> fresh(new chunk());
+			_construct(*fresh, key, std::forward<Args>(args)...);
+			m_chunk_keys.push_back(key);
+			try {
+				m_chunks.push_back(std::move(fresh));
+			} catch (...) {
+				m_chunk_keys.pop_back();
+				throw;
+			}
+			search_type::_append(m_chunk_keys.data(), m_chunk_keys.size());
+		} else {
+			_construct(*m_chunks.back(), key, std::forward<Args>(args)...);
+		}
+		++m_size;
+	}
+	inline void emplace_back(const value_type &p) {
+		emplace_back(p.first, p.second);
+	}
+	inline void push_back(const value_type &p) {
+		emplace_back(p.first, p.second);
+	}
+	inline void push_back(value_type &&p) {
+		emplace_back(p.first, std::move(p.second));
+	}
+	inline void pop_back() {
+		chunk &c = *m_chunks.back();
+		c.data[--c.size].~value_type();
+		--m_size;
+		if (c.size == 0) {
+			m_chunks.pop_back();
+			m_chunk_keys.pop_back();
+			search_type::_refresh(m_chunk_keys.data(), m_chunk_keys.size());
+		} else {
+			c.search._refresh(c.data, c.size);
+		}
+	}
+
+	// Iterators
+	inline iterator begin() noexcept { return iterator(this, 0); }
+	inline iterator end() noexcept { return iterator(this, m_size); }
+	inline const_iterator begin() const noexcept { return const_iterator(this, 0); }
+	inline const_iterator end() const noexcept { return const_iterator(this, m_size); }
+	inline const_iterator cbegin() const noexcept { return begin(); }
+	inline const_iterator cend() const noexcept { return end(); }
+
+	// Access operations
+	inline iterator at(const K &key) {
+		auto pos = find(key);
+		if (pos == end())
+			throw std::out_of_range("iterator chunked_tuple_vector::at(const K &key)");
+		return pos;
+	}
+	inline const_iterator at(const K &key) const {
+		return at(key, m_ctx);
+	}
+	inline const_iterator at(const K &key, context_type &ctx) const {
+		auto pos = find(key, ctx);
+		if (pos == end())
+			throw std::out_of_range("const_iterator chunked_tuple_vector::at(const K &key) const");
+		return pos;
+	}
+	inline const_reference operator[](size_t idx) const {
+		return m_chunks[idx / Chunk]->data[idx & (Chunk - 1)];
+	}
+	inline reference operator[](size_t idx) {
+		return m_chunks[idx / Chunk]->data[idx & (Chunk - 1)];
+	}
+	inline const_reference front() const { return (*this)[0]; }
+	inline reference front() { return (*this)[0]; }
+	inline const_reference back() const { return (*this)[m_size - 1]; }
+	inline reference back() { return (*this)[m_size - 1]; }
+	inline iterator lower_bound(const K &key) {
+		return begin() + _lower_bound(key, m_ctx);
+	}
+	inline const_iterator lower_bound(const K &key) const {
+		return lower_bound(key, m_ctx);
+	}
+	/// lower_bound() using the given search context, safe to call from several threads at once
+	inline const_iterator lower_bound(const K &key, context_type &ctx) const {
+		return begin() + _lower_bound(key, ctx);
+	}
+	inline iterator find(const K &key) {
+		return begin() + _find(key, m_ctx);
+	}
+	inline const_iterator find(const K &key) const {
+		return find(key, m_ctx);
+	}
+	/// find() using the given search context, safe to call from several threads at once
+	inline const_iterator find(const K &key, context_type &ctx) const {
+		return begin() + _find(key, ctx);
+	}
+	inline iterator upper_bound(const K &key) {
+		return begin() + _upper_bound(key, m_ctx);
+	}
+	inline const_iterator upper_bound(const K &key) const {
+		return upper_bound(key, m_ctx);
+	}
+	/// upper_bound() using the given search context, safe to call from several threads at once
+	inline const_iterator upper_bound(const K &key, context_type &ctx) const {
+		return begin() + _upper_bound(key, ctx);
+	}
+	inline std::pair<iterator, iterator> equal_range(const K &key) {
+		auto first = lower_bound(key);
+		return std::make_pair(first, first != end() && first->first == key ? first + 1 : first);
+	}
+	inline std::pair<const_iterator, const_iterator> equal_range(const K &key) const {
+		return equal_range(key, m_ctx);
+	}
+	/// equal_range() using the given search context, safe to call from several threads at once
+	inline std::pair<const_iterator, const_iterator> equal_range(const K &key, context_type &ctx) const {
+		auto first = lower_bound(key, ctx);
+		return std::make_pair(first, first != end() && first->first == key ? first + 1 : first);
+	}
+
+	/// first key of every chunk
+	inline const std::vector<K> &chunk_keys() const noexcept { return m_chunk_keys; }
+
+protected:
+	/// interpolation search over the elements of one chunk
+	struct chunk_search : interpolation_search<K, value_type> {
+		typedef interpolation_search<K, value_type> base;
+		using base::_refresh;
+		using base::_append;
+		using base::_find;
+		using base::_lower_bound;
+		using base::_upper_bound;
+		using base::_end;
+	};
+
+	/// Chunk elements, of which the first size are constructed, plus their interpolation line
+	struct chunk {
+		chunk() : data(std::allocator<value_type>().allocate(Chunk)) { }
+		chunk(const chunk &) = delete;
+		chunk &operator=(const chunk &) = delete;
+		~chunk() {
+			for (size_t i = 0; i < size; i++)
+				data[i].~value_type();
+			std::allocator<value_type>().deallocate(data, Chunk);
+		}
+		value_type *data;
+		size_t size = 0;
+		chunk_search search;
+	};
+
+	/// construct an element at the end of chunk c
+	template <typename... Args> static inline void _construct(chunk &c, const K &key, Args&&... args) {
+		::new ((void *)(c.data + c.size)) value_type(std::piecewise_construct, std::forward_as_tuple(key),
+			std::forward_as_tuple(std::forward<Args>(args)...));
+		++c.size;
+		c.search._append(c.data, c.size);
+	}
+
+	/**
+	 * \brief chunk which may contain key, i.e. the last chunk whose first key is not greater
+	 * \return chunk index, or -1 if key is less than the first key
+	 */
+	inline ptrdiff_t _chunk_of(const K &key, context_type &ctx) const {
+		return search_type::_upper_bound(key, ctx) - m_chunk_keys.data() - 1;
+	}
+
+	/*
+	 * The second search inside the chunk uses a fresh search context every time, so these
+	 * lookups never write to the chunks and lookups with a caller-provided context stay
+	 * thread-safe. All chunks but the last one are full, so chunk c starts at c * Chunk.
+	 */
+	inline size_t _find(const K &key, context_type &ctx) const {
+		ptrdiff_t c = _chunk_of(key, ctx);
+		if (c < 0)
+			return m_size;
+		const chunk &ch = *m_chunks[c];
+		typename chunk_search::context_type local;
+		const value_type *p = ch.search._find(key, local);
+		return p == ch.search._end() ? m_size : c * Chunk + (p - ch.data);
+	}
+	inline size_t _lower_bound(const K &key, context_type &ctx) const {
+		ptrdiff_t c = _chunk_of(key, ctx);
+		if (c < 0)
+			return 0;
+		const chunk &ch = *m_chunks[c];
+		typename chunk_search::context_type local;
+		return c * Chunk + (ch.search._lower_bound(key, local) - ch.data);
+	}
+	inline size_t _upper_bound(const K &key, context_type &ctx) const {
+		ptrdiff_t c = _chunk_of(key, ctx);
+		if (c < 0)
+			return 0;
+		const chunk &ch = *m_chunks[c];
+		typename chunk_search::context_type local;
+		return c * Chunk + (ch.search._upper_bound(key, local) - ch.data);
+	}
+
+	inline void _refresh() {
+		search_type::_refresh(m_chunk_keys.data(), m_chunk_keys.size());
+	}
+
+private:
+	/// the chunks, only the pointers move when the directory grows
+	std::vector<std::unique_ptr<chunk>> m_chunks;
+	/// first key of every chunk, searched to find the chunk of a key
+	std::vector<K> m_chunk_keys;
+	/// number of elements
+	size_t m_size = 0;
+};
+
+template<typename K, typename V, typename Stats, size_t Chunk>
+constexpr size_t chunked_tuple_vector<K, V, Stats, Chunk>::chunk_size;
+
+#endif /* __chunked_tuple_vector_h */
@@ -0,0 +1,368 @@
+/**
+ * \file	columnar_tuple_vector.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __columnar_tuple_vector_h
+#define __columnar_tuple_vector_h
+
+#include <iterator>
+#include <type_traits>
+
+#include "tuple_vector.h"
+
+/**
+ * \brief Random access iterator over the key and value columns of a columnar_tuple_vector.
+ *		Dereferencing yields a std::pair of references into both columns, so the usual
+ *		it->first and it->second syntax works just like with tuple_vector.
+ * \tparam K key type
+ * \tparam V value type
+ * \tparam Const true for a const_iterator
+ */
+template<typename K, typename V, bool Const>
+class columnar_iterator {
+public:
+	typedef std::random_access_iterator_tag									iterator_category;
+	typedef std::pair<K,V>													value_type;
+	typedef std::ptrdiff_t													difference_type;
+	typedef typename std::conditional<Const, const V, V>::type				mapped_type;
+	typedef std::pair<const K &, mapped_type &>								reference;
+
+	/// proxy returned by operator->() since there is no std::pair object we could point to
+	struct pointer {
+		reference ref;
+		inline const reference *operator->() const { return &ref; }
+	};
+
+	columnar_iterator() { }
+	columnar_iterator(const K *key, mapped_type *value) : m_key(key), m_value(value) { }
+	/// allow conversion from iterator to const_iterator
+	template<bool C, typename = typename std::enable_if<Const && !C>::type>
+	columnar_iterator(const columnar_iterator<K, V, C> &it) : m_key(it.key_ptr()), m_value(it.value_ptr()) { }
+
+	inline reference operator*() const { return reference(*m_key, *m_value); }
+	inline pointer operator->() const { return pointer{**this}; }
+	inline reference operator[](difference_type n) const { return reference(m_key[n], m_value[n]); }
+
+	inline columnar_iterator &operator++() { ++m_key; ++m_value; return *this; }
+	inline columnar_iterator &operator--() { --m_key; --m_value; return *this; }
+	inline columnar_iterator operator++(int) { columnar_iterator it(*this); ++*this; return it; }
+	inline columnar_iterator operator--(int) { columnar_iterator it(*this); --*this; return it; }
+	inline columnar_iterator &operator+=(difference_type n) { m_key += n; m_value += n; return *this; }
+	inline columnar_iterator &operator-=(difference_type n) { m_key -= n; m_value -= n; return *this; }
+	inline columnar_iterator operator+(difference_type n) const { return columnar_iterator(m_key + n, m_value + n); }
+	inline columnar_iterator operator-(difference_type n) const { return columnar_iterator(m_key - n, m_value - n); }
+	inline difference_type operator-(const columnar_iterator &it) const { return m_key - it.m_key; }
+
+	inline bool operator==(const columnar_iterator &it) const { return m_key == it.m_key; }
+	inline bool operator!=(const columnar_iterator &it) const { return m_key != it.m_key; }
+	inline bool operator<(const columnar_iterator &it) const { return m_key < it.m_key; }
+	inline bool operator>(const columnar_iterator &it) const { return m_key > it.m_key; }
+	inline bool operator<=(const columnar_iterator &it) const { return m_key <= it.m_key; }
+	inline bool operator>=(const columnar_iterator &it) const { return m_key >= it.m_key; }
+
+	inline const K *key_ptr() const { return m_key; }
+	inline mapped_type *value_ptr() const { return m_value; }
+
+private:
+	const K *m_key = nullptr;
+	mapped_type *m_value = nullptr;
+};
+
+/**
+ * \brief This class is a "structure of arrays" variant of tuple_vector: keys and values are kept
+ *		in two separate std::vectors instead of one std::vector of std::pair<K,V>. The interpolation
+ *		search in find() and lower_bound() only ever touches the contiguous key column, so a resync
+ *		scan pulls only keys through the cache, no matter how big V is. The value is only read once
+ *		the sought element has been found.
+ *		Like tuple_vector, the container does not sort, so any data needs to be presorted.
+ * \tparam K A datetime type, e.g. time_t, boost::posix_time::ptime or similar.
+ * \tparam V A value type, can be whatever is appropriate for the use-case.
+ * \tparam Stats lookup statistics policy, no_search_stats (default) or search_stats
+ * \tparam Allocator allocator, rebound to K and V for the two columns (see allocators.h)
+ */
+template<typename K, typename V, typename Stats = no_search_stats, typename Allocator = std::allocator<std::pair<K,V>>>
+class columnar_tuple_vector : public interpolation_search<K, K, Stats> {
+	typedef interpolation_search<K, K, Stats> search_type;
+	using search_type::m_ctx;
+public:
+	typedef std::pair<K,V>										value_type;
+	typedef Allocator											allocator_type;
+	typedef std::vector<K, typename std::allocator_traits<Allocator>::template rebind_alloc<K>>	key_column;
+	typedef std::vector<V, typename std::allocator_traits<Allocator>::template rebind_alloc<V>>	value_column;
+	typedef columnar_iterator<K, V, false>						iterator;
+	typedef columnar_iterator<K, V, true>						const_iterator;
+	typedef typename iterator::reference						reference;
+	typedef typename const_iterator::reference					const_reference;
+	typedef typename key_column::size_type						size_type;
+	typedef typename search_type::context_type					context_type;
+
+	columnar_tuple_vector() { }
+
+	explicit columnar_tuple_vector(const allocator_type &alloc) : m_keys(alloc), m_values(alloc) { }
+
+	columnar_tuple_vector(size_type n, const allocator_type &alloc = allocator_type()) : m_keys(n, alloc), m_values(n, alloc) {
+		_refresh();
+	}
+
+	/// copy of x including its learned index and aggregate index, which are copied, not rebuilt
+	columnar_tuple_vector(const columnar_tuple_vector &x) : search_type(x), m_keys(x.m_keys), m_values(x.m_values),
+		m_aggregates(x.m_aggregates) { search_type::_rebase(m_keys.data()); }
+
+	/// take over the columns, the learned index and the aggregate index of x in O(1), x is left empty
+	columnar_tuple_vector(columnar_tuple_vector &&x) noexcept : search_type(std::move(x)), m_keys(std::move(x.m_keys)),
+		m_values(std::move(x.m_values)), m_aggregates(std::move(x.m_aggregates)) {
+		search_type::_rebase(m_keys.data());
+		x._reset();
+	}
+
+	~columnar_tuple_vector() { }
+
+	/// copy of x including its learned index and aggregate index, like the copy constructor
+	inline columnar_tuple_vector &operator=(const columnar_tuple_vector &x) {
+		m_keys = x.m_keys;
+		m_values = x.m_values;
+		search_type::operator=(x);
+		m_aggregates = x.m_aggregates;
+		search_type::_rebase(m_keys.data());
+		return *this;
+	}
+	/// like the move constructor, the elements are moved one by one only if the allocator demands it
+	inline columnar_tuple_vector &operator=(columnar_tuple_vector &&x)
+		noexcept(std::is_nothrow_move_assignable<key_column>::value && std::is_nothrow_move_assignable<value_column>::value) {
+		m_keys = std::move(x.m_keys);
+		m_values = std::move(x.m_values);
+		search_type::operator=(std::move(x));
+		m_aggregates = std::move(x.m_aggregates);
+		search_type::_rebase(m_keys.data());
+		x._reset();
+		return *this;
+	}
+
+	// Capacity
+	inline size_type size() const noexcept { return m_keys.size(); }
+	inline bool empty() const noexcept { return m_keys.empty(); }
+	inline size_type capacity() const noexcept { return m_keys.capacity(); }
+	inline void reserve(size_type n) {
+		// values first: if reserving the keys throws, the searched key column is left untouched
+		m_values.reserve(n);
+		m_keys.reserve(n);
+		_refresh();
+	}
+
+	// Modifying operations.
+	void clear() noexcept {
+		m_keys.clear();
+		m_values.clear();
+		_refresh();
+	}
+	/// append an element, if constructing the value throws the key is taken back before rethrowing
+	template <typename... Args> inline void emplace_back(const K &key, Args&&... args) {
+		m_keys.emplace_back(key);
+		try {
+			m_values.emplace_back(std::forward<Args>(args)...);
+		} catch (...) {
+			m_keys.pop_back();
+			// the key column may have been reallocated, so the search has to be pointed at it again
+			search_type::_refresh(m_keys.data(), m_keys.size());
+			throw;
+		}
+		_append();
+	}
+	inline void emplace_back(const value_type &p) {
+		emplace_back(p.first, p.second);
+	}
+	inline void push_back(const value_type &p) {
+		emplace_back(p.first, p.second);
+	}
+	inline void push_back(value_type &&p) {
+		emplace_back(p.first, std::move(p.second));
+	}
+	inline void pop_back() {
+		m_keys.pop_back();
+		m_values.pop_back();
+		_refresh();
+	}
+	inline void resize(size_type n) {
+		m_keys.resize(n);
+		m_values.resize(n);
+		_refresh();
+	}
+	inline void shrink_to_fit() {
+		m_keys.shrink_to_fit();
+		m_values.shrink_to_fit();
+		_refresh();
+	}
+
+	// Iterators
+	inline iterator begin() noexcept { return iterator(m_keys.data(), m_values.data()); }
+	inline iterator end() noexcept { return begin() + size(); }
+	inline const_iterator begin() const noexcept { return const_iterator(m_keys.data(), m_values.data()); }
+	inline const_iterator end() const noexcept { return begin() + size(); }
+	inline const_iterator cbegin() const noexcept { return begin(); }
+	inline const_iterator cend() const noexcept { return end(); }
+
+	// Access operations
+	inline iterator at(const K &key) {
+		auto pos = find(key);
+		if (pos == end())
+			throw std::out_of_range("iterator columnar_tuple_vector::at(const K &key)");
+		return pos;
+	}
+	inline const_iterator at(const K &key) const {
+		return at(key, m_ctx);
+	}
+	inline const_iterator at(const K &key, context_type &ctx) const {
+		auto pos = find(key, ctx);
+		if (pos == end())
+			throw std::out_of_range("const_iterator columnar_tuple_vector::at(const K &key) const");
+		return pos;
+	}
+	inline const_reference operator[](size_t idx) const {
+		return const_reference(m_keys[idx], m_values[idx]);
+	}
+	inline reference operator[](size_t idx) {
+		return reference(m_keys[idx], m_values[idx]);
+	}
+	inline const_reference operator[](const K &key) const {
+		return *lower_bound(key);
+	}
+	inline reference operator[](const K &key) {
+		return *lower_bound(key);
+	}
+	inline const_reference front() const { return *begin(); }
+	inline reference front() { return *begin(); }
+	inline const_reference back() const { return *(end() - 1); }
+	inline reference back() { return *(end() - 1); }
+	inline iterator lower_bound(const K &key) {
+		return begin() + (search_type::_lower_bound(key, m_ctx) - m_keys.data());
+	}
+	inline const_iterator lower_bound(const K &key) const {
+		return lower_bound(key, m_ctx);
+	}
+	/// lower_bound() using the given search context, safe to call from several threads at once
+	inline const_iterator lower_bound(const K &key, context_type &ctx) const {
+		return begin() + (search_type::_lower_bound(key, ctx) - m_keys.data());
+	}
+	inline iterator find(const K &key) {
+		return begin() + (search_type::_find(key, m_ctx) - m_keys.data());
+	}
+	inline const_iterator find(const K &key) const {
+		return find(key, m_ctx);
+	}
+	/// find() using the given search context, safe to call from several threads at once
+	inline const_iterator find(const K &key, context_type &ctx) const {
+		return begin() + (search_type::_find(key, ctx) - m_keys.data());
+	}
+	/**
+	 * \brief find() for a whole range of sorted or unsorted keys
+	 * \param out receives the index of every key, size() if the key was not found
+	 */
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt find_many(InputIt first, InputIt last, OutputIt out) const {
+		return find_many(first, last, out, m_ctx);
+	}
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt find_many(InputIt first, InputIt last, OutputIt out, context_type &ctx) const {
+		return search_type::_search_many(first, last, out, true, ctx);
+	}
+	/**
+	 * \brief lower_bound() for a whole range of sorted or unsorted keys
+	 * \param out receives the index of every lower bound, size() if there is none
+	 */
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt lower_bound_many(InputIt first, InputIt last, OutputIt out) const {
+		return lower_bound_many(first, last, out, m_ctx);
+	}
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt lower_bound_many(InputIt first, InputIt last, OutputIt out, context_type &ctx) const {
+		return search_type::_search_many(first, last, out, false, ctx);
+	}
+	inline iterator upper_bound(const K &key) {
+		return begin() + (search_type::_upper_bound(key, m_ctx) - m_keys.data());
+	}
+	inline const_iterator upper_bound(const K &key) const {
+		return upper_bound(key, m_ctx);
+	}
+	/// upper_bound() using the given search context, safe to call from several threads at once
+	inline const_iterator upper_bound(const K &key, context_type &ctx) const {
+		return begin() + (search_type::_upper_bound(key, ctx) - m_keys.data());
+	}
+	inline std::pair<iterator, iterator> equal_range(const K &key) {
+		auto first = lower_bound(key);
+		return std::make_pair(first, first != end() && first->first == key ? first + 1 : first);
+	}
+	inline std::pair<const_iterator, const_iterator> equal_range(const K &key) const {
+		return equal_range(key, m_ctx);
+	}
+	/// equal_range() using the given search context, safe to call from several threads at once
+	inline std::pair<const_iterator, const_iterator> equal_range(const K &key, context_type &ctx) const {
+		auto first = lower_bound(key, ctx);
+		return std::make_pair(first, first != end() && first->first == key ? first + 1 : first);
+	}
+
+	/// build the optional aggregate index over the value column, see tuple_vector::build_aggregates()
+	void build_aggregates() {
+		m_aggregates.build(m_values.size(), value_at());
+	}
+	/// remove the aggregate index, aggregate() goes back to walking the window
+	void drop_aggregates() { m_aggregates.drop(); }
+	/// memory used by the aggregate index in bytes
+	size_t aggregate_bytes() const { return m_aggregates.bytes(); }
+
+	/// count, sum, min and max of all values with keys in [t0, t1), see tuple_vector::aggregate()
+	inline window_aggregate<V> aggregate(const K &t0, const K &t1) const {
+		return aggregate(t0, t1, m_ctx);
+	}
+	/// aggregate() using the given search context, safe to call from several threads at once
+	inline window_aggregate<V> aggregate(const K &t0, const K &t1, context_type &ctx) const {
+		const K *first = search_type::_lower_bound(t0, ctx);
+		const K *last = t0 < t1 ? search_type::_lower_bound_after(first, t1, ctx) : first;
+		return m_aggregates.enabled() ? m_aggregates.query(first - m_keys.data(), last - m_keys.data(), value_at())
+			: aggregate_index<V>::walk(first - m_keys.data(), last - m_keys.data(), value_at());
+	}
+
+	/// read-only access to the contiguous key column
+	inline const key_column &keys() const noexcept { return m_keys; }
+	/// read-only access to the contiguous value column
+	inline const value_column &values() const noexcept { return m_values; }
+	/// allocator of the columns
+	inline allocator_type get_allocator() const noexcept { return allocator_type(m_keys.get_allocator()); }
+
+protected:
+	/// functor returning the value of the i-th element for the aggregate index
+	struct value_at_type {
+		const V *values;
+		inline const V &operator()(size_t i) const { return values[i]; }
+	};
+	inline value_at_type value_at() const { return value_at_type{m_values.data()}; }
+
+	/// empty the moved-from container and drop everything built over its elements
+	inline void _reset() noexcept {
+		m_keys.clear();
+		m_values.clear();
+		search_type::_reset(m_keys.data());
+		m_aggregates.drop();
+	}
+	inline void _refresh() {
+		search_type::_refresh(m_keys.data(), m_keys.size());
+		if (m_aggregates.enabled())
+			build_aggregates();
+	}
+	inline void _append() {
+		search_type::_append(m_keys.data(), m_keys.size());
+		if (m_aggregates.enabled())
+			m_aggregates.extend(m_values.size(), value_at());
+	}
+
+private:
+	/// key column, searched by find() and lower_bound()
+	key_column m_keys;
+	/// value column, only accessed once a key has been found
+	value_column m_values;
+	/// optional aggregate index over the value column, see build_aggregates()
+	aggregate_index<V> m_aggregates;
+};
+
+#endif /* __columnar_tuple_vector_h */
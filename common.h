@@ -20,7 +20,14 @@ public:
 /// sample key functor specialisation for ptime
 template<> double key<my_ptime>::operator()(const my_ptime &x) const { return (x-ptime(date(1900, Jan, 1))).total_milliseconds(); }
 
-/// sample key functor specialisation for time_t
-template<> double key<time_t>::operator()(const time_t &x) const { return x; }
+/// sample key_codec specialisation for ptime, needed by compressed_tuple_vector
+template<> struct key_codec<my_ptime> {
+	static int64_t encode(const my_ptime &x) { return (x - ptime(date(1970, Jan, 1))).ticks(); }
+	static my_ptime decode(int64_t x) {
+		my_ptime t;
+		t += time_duration(0, 0, 0, x);
+		return t;
+	}
+};
 
 #endif
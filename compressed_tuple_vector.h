@@ -0,0 +1,371 @@
+/**
+ * \file	compressed_tuple_vector.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __compressed_tuple_vector_h
+#define __compressed_tuple_vector_h
+
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#include "tuple_vector.h"
+
+/// number of keys per compressed block of compressed_tuple_vector
+#ifndef TUPLE_VECTOR_KEY_BLOCK
+#define TUPLE_VECTOR_KEY_BLOCK 128
+#endif
+
+template<typename K, typename V> class compressed_tuple_vector;
+
+/**
+ * \brief Random access iterator over a compressed_tuple_vector. Keys are decoded on the fly, so
+ *		dereferencing yields a std::pair of the key by value and a reference to the value.
+ * \tparam K key type
+ * \tparam V value type
+ */
+template<typename K, typename V>
+class compressed_iterator {
+public:
+	typedef std::random_access_iterator_tag									iterator_category;
+	typedef std::pair<K,V>													value_type;
+	typedef std::ptrdiff_t													difference_type;
+	typedef std::pair<K, const V &>											reference;
+
+	/// proxy returned by operator->() since there is no std::pair object we could point to
+	struct pointer {
+		reference ref;
+		inline const reference *operator->() const { return &ref; }
+	};
+
+	compressed_iterator() { }
+	compressed_iterator(const compressed_tuple_vector<K,V> *c, size_t idx) : m_c(c), m_idx(idx) { }
+
+	inline reference operator*() const { return (*m_c)[m_idx]; }
+	inline pointer operator->() const { return pointer{**this}; }
+	inline reference operator[](difference_type n) const { return (*m_c)[m_idx + n]; }
+
+	inline compressed_iterator &operator++() { ++m_idx; return *this; }
+	inline compressed_iterator &operator--() { --m_idx; return *this; }
+	inline compressed_iterator operator++(int) { compressed_iterator it(*this); ++m_idx; return it; }
+	inline compressed_iterator operator--(int) { compressed_iterator it(*this); --m_idx; return it; }
+	inline compressed_iterator &operator+=(difference_type n) { m_idx += n; return *this; }
+	inline compressed_iterator &operator-=(difference_type n) { m_idx -= n; return *this; }
+	inline compressed_iterator operator+(difference_type n) const { return compressed_iterator(m_c, m_idx + n); }
+	inline compressed_iterator operator-(difference_type n) const { return compressed_iterator(m_c, m_idx - n); }
+	inline difference_type operator-(const compressed_iterator &it) const { return m_idx - it.m_idx; }
+
+	inline bool operator==(const compressed_iterator &it) const { return m_idx == it.m_idx; }
+	inline bool operator!=(const compressed_iterator &it) const { return m_idx != it.m_idx; }
+	inline bool operator<(const compressed_iterator &it) const { return m_idx < it.m_idx; }
+	inline bool operator>(const compressed_iterator &it) const { return m_idx > it.m_idx; }
+	inline bool operator<=(const compressed_iterator &it) const { return m_idx <= it.m_idx; }
+	inline bool operator>=(const compressed_iterator &it) const { return m_idx >= it.m_idx; }
+
+	/// index of the element the iterator points to
+	inline size_t index() const { return m_idx; }
+
+private:
+	const compressed_tuple_vector<K,V> *m_c = nullptr;
+	size_t m_idx = 0;
+};
+
+/**
+ * \brief This class is an append-only variant of columnar_tuple_vector that stores its keys
+ *		compressed, for long series of regularly spaced timestamps where the key would otherwise
+ *		take up as much memory as the value.
+ *		The keys are split into blocks of TUPLE_VECTOR_KEY_BLOCK. Every block keeps its first key
+ *		uncompressed in a separate column, which the interpolation search runs over to pick the
+ *		block. Within a block, the keys are stored as a linear frame of reference: the block
+ *		stores the average step between its keys and every key is bit-packed as its (small,
+ *		non-negative) residual from first + i * step, using as few bits as the largest residual
+ *		of the block needs. Perfectly regular keys take 0 bits. Since any key of a block can be
+ *		decoded on its own, the residual range bounds the position of a key within its block
+ *		and only a handful of keys need to be decoded per lookup, none for regular keys.
+ *		Keys appended to a block that is not yet complete are kept uncompressed until the block
+ *		is full. Lookups do not learn from previous ones (see _block_of()), so, unlike the
+ *		other containers, they never write to the container and need no search_context.
+ *		The keys of a block must span less than 2^62 key_codec units.
+ * \tparam K A datetime type with a key<K> and a key_codec<K>, e.g. time_t.
+ * \tparam V A value type, can be whatever is appropriate for the use-case.
+ */
+template<typename K, typename V>
+class compressed_tuple_vector : public interpolation_search<K, K> {
+	typedef interpolation_search<K, K> search_type;
+	typedef key_codec<K> codec;
+public:
+	typedef std::pair<K,V>										value_type;
+	typedef compressed_iterator<K, V>							const_iterator;
+	typedef const_iterator										iterator;
+	typedef typename const_iterator::reference					const_reference;
+	typedef size_t												size_type;
+	static constexpr size_t block = TUPLE_VECTOR_KEY_BLOCK;
+	static_assert(block > 1, "TUPLE_VECTOR_KEY_BLOCK must be greater than 1");
+
+	compressed_tuple_vector() { }
+
+	/// append all elements of [first, last), e.g. from a tuple_vector
+	template<typename InputIt>
+	compressed_tuple_vector(InputIt first, InputIt last) {
+		for (; first != last; ++first)
+			emplace_back(first->first, first->second);
+	}
+
+	compressed_tuple_vector(const compressed_tuple_vector &x) : search_type(x), m_block_keys(x.m_block_keys),
+		m_blocks(x.m_blocks), m_bits(x.m_bits), m_bit_count(x.m_bit_count), m_tail(x.m_tail), m_values(x.m_values) { _refresh(); }
+
+	compressed_tuple_vector(compressed_tuple_vector &&x) : search_type(x), m_block_keys(std::move(x.m_block_keys)),
+		m_blocks(std::move(x.m_blocks)), m_bits(std::move(x.m_bits)), m_bit_count(x.m_bit_count), m_tail(std::move(x.m_tail)),
+		m_values(std::move(x.m_values)) {
+		x.clear();
+		_refresh();
+	}
+
+	compressed_tuple_vector &operator=(const compressed_tuple_vector &x) {
+		m_block_keys = x.m_block_keys;
+		m_blocks = x.m_blocks;
+		m_bits = x.m_bits;
+		m_bit_count = x.m_bit_count;
+		m_tail = x.m_tail;
+		m_values = x.m_values;
+		search_type::operator=(x);
+		_refresh();
+		return *this;
+	}
+	compressed_tuple_vector &operator=(compressed_tuple_vector &&x) {
+		m_block_keys = std::move(x.m_block_keys);
+		m_blocks = std::move(x.m_blocks);
+		m_bits = std::move(x.m_bits);
+		m_bit_count = x.m_bit_count;
+		m_tail = std::move(x.m_tail);
+		m_values = std::move(x.m_values);
+		search_type::operator=(x);
+		_refresh();
+		x.clear();
+		return *this;
+	}
+
+	// Capacity
+	inline size_type size() const noexcept { return m_values.size(); }
+	inline bool empty() const noexcept { return m_values.empty(); }
+	inline void reserve(size_type n) {
+		m_values.reserve(n);
+		m_block_keys.reserve(n / block);
+		m_blocks.reserve(n / block);
+		_refresh();
+	}
+
+	/// memory used by the keys (block keys, block headers, residuals and the incomplete block) in bytes
+	size_t key_bytes() const {
+		return m_block_keys.capacity() * sizeof(K) + m_blocks.capacity() * sizeof(block_header)
+			+ m_bits.capacity() * sizeof(uint64_t) + m_tail.capacity() * sizeof(K);
+	}
+
+	// Modifying operations
+	void clear() noexcept {
+		m_block_keys.clear();
+		m_blocks.clear();
+		m_bits.clear();
+		m_bit_count = 0;
+		m_tail.clear();
+		m_values.clear();
+		_refresh();
+	}
+	/// append an element, the key must be greater than the key of the back element
+	template <typename... Args> inline void emplace_back(const K &key, Args&&... args) {
+		m_values.emplace_back(std::forward<Args>(args)...);
+		m_tail.push_back(key);
+		if (m_tail.size() == block)
+			_compress();
+	}
+	inline void emplace_back(const value_type &p) {
+		emplace_back(p.first, p.second);
+	}
+	inline void push_back(const value_type &p) {
+		emplace_back(p.first, p.second);
+	}
+
+	// Iterators
+	inline const_iterator begin() const noexcept { return const_iterator(this, 0); }
+	inline const_iterator end() const noexcept { return const_iterator(this, size()); }
+	inline const_iterator cbegin() const noexcept { return begin(); }
+	inline const_iterator cend() const noexcept { return end(); }
+
+	// Access operations
+	/// decode the key of the idx-th element
+	inline K key_at(size_t idx) const {
+		size_t b = idx / block;
+		if (b >= m_blocks.size())
+			return m_tail[idx - m_blocks.size() * block];
+		const block_header &h = m_blocks[b];
+		size_t i = idx % block;
+		return codec::decode((int64_t)((uint64_t)codec::encode(m_block_keys[b])
+			+ (uint64_t)(i * h.step + h.base + (int64_t)_residual(h, i))));
+	}
+	inline const_reference operator[](size_t idx) const {
+		return const_reference(key_at(idx), m_values[idx]);
+	}
+	inline const_reference front() const { return (*this)[0]; }
+	inline const_reference back() const { return (*this)[size() - 1]; }
+	inline const_iterator at(const K &key) const {
+		auto pos = find(key);
+		if (pos == end())
+			throw std::out_of_range("const_iterator compressed_tuple_vector::at(const K &key) const");
+		return pos;
+	}
+	inline const_iterator lower_bound(const K &key) const {
+		return const_iterator(this, _lower_bound_index(key));
+	}
+	inline const_iterator upper_bound(const K &key) const {
+		size_t idx = _lower_bound_index(key);
+		return const_iterator(this, idx < size() && key_at(idx) == key ? idx + 1 : idx);
+	}
+	inline const_iterator find(const K &key) const {
+		size_t idx = _lower_bound_index(key);
+		return const_iterator(this, idx < size() && key_at(idx) == key ? idx : size());
+	}
+
+	/// read-only access to the value column
+	inline const std::vector<V> &values() const noexcept { return m_values; }
+
+protected:
+	/// everything needed to decode the keys of a block besides its first key
+	struct block_header {
+		/// bit offset of the first residual in m_bits
+		uint64_t offset;
+		/// average distance between two keys of the block
+		int64_t step;
+		/// smallest residual, i.e. key i is first + i * step + base + residual(i)
+		int64_t base;
+		/// ceil(largest residual(i) / step), i.e. by how many positions a residual can move a key
+		uint64_t reach;
+		/// difference between the last and the first key of the block
+		uint64_t span;
+		/// bits per residual
+		unsigned width;
+	};
+
+	/// residual of the i-th key of the block
+	inline uint64_t _residual(const block_header &h, size_t i) const {
+		if (h.width == 0)
+			return 0;
+		uint64_t pos = h.offset + i * h.width, word = pos >> 6, shift = pos & 63;
+		uint64_t v = m_bits[word] >> shift;
+		if (shift + h.width > 64)
+			v |= m_bits[word + 1] << (64 - shift);
+		return h.width == 64 ? v : v & (((uint64_t)1 << h.width) - 1);
+	}
+
+	/// compress the full block of keys in m_tail
+	void _compress() {
+		const int64_t first = codec::encode(m_tail[0]);
+		block_header h;
+		h.offset = m_bit_count;
+		h.span = (uint64_t)codec::encode(m_tail[block - 1]) - (uint64_t)first;
+		h.step = h.span / (block - 1);
+		int64_t res[block];
+		int64_t lo = 0, hi = 0;
+		for (size_t i = 0; i < block; ++i) {
+			res[i] = (int64_t)((uint64_t)codec::encode(m_tail[i]) - (uint64_t)first) - (int64_t)i * h.step;
+			lo = std::min(lo, res[i]);
+			hi = std::max(hi, res[i]);
+		}
+		const uint64_t top = (uint64_t)(hi - lo);
+		h.base = lo;
+		h.reach = (top + h.step - 1) / h.step;
+		h.width = top ? 64 - __builtin_clzll(top) : 0;
+		// bit-pack the residuals, m_bits always has one spare word for _residual()
+		m_bit_count += block * h.width;
+		m_bits.resize((m_bit_count + 63) / 64 + 1);
+		for (size_t i = 0; h.width && i < block; ++i) {
+			uint64_t v = (uint64_t)(res[i] - lo), pos = h.offset + i * h.width, word = pos >> 6, shift = pos & 63;
+			m_bits[word] |= v << shift;
+			if (shift + h.width > 64)
+				m_bits[word + 1] |= v >> (64 - shift);
+		}
+		m_blocks.push_back(h);
+		m_block_keys.push_back(m_tail[0]);
+		m_tail.clear();
+		search_type::_append(m_block_keys.data(), m_block_keys.size());
+	}
+
+	/**
+	 * \brief position of the first key of block b not less than key, block if there is none
+	 *		Key i is first + i * step + base + residual(i) with 0 <= residual(i) <= reach * step.
+	 *		With t = key - first - base, key i is not less than key if i >= hi = ceil(t / step),
+	 *		and less than key if i < hi - reach, so only the few candidates in between are binary
+	 *		searched, none at all for perfectly regular keys.
+	 */
+	inline size_t _block_lower_bound(size_t b, const K &key) const {
+		const block_header &h = m_blocks[b];
+		uint64_t diff = (uint64_t)codec::encode(key) - (uint64_t)codec::encode(m_block_keys[b]);
+		if (diff > h.span)
+			return block;
+		const uint64_t t = diff - h.base, step = h.step;
+		size_t hi = t / step + (t % step != 0);
+		size_t lo = hi > h.reach ? hi - h.reach : 0;
+		hi = std::min((size_t)block, hi);
+		while (lo < hi) {
+			size_t mid = (lo + hi) / 2;
+			if (mid * step + _residual(h, mid) < t)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+
+	/// index of the first element not less than key, size() if there is none
+	inline size_t _lower_bound_index(const K &key) const {
+		const size_t compressed = m_blocks.size() * block;
+		if (!m_tail.empty() && !(key < m_tail.front()))
+			return compressed + (std::lower_bound(m_tail.begin(), m_tail.end(), key) - m_tail.begin());
+		if (m_blocks.empty())
+			return 0;
+		const K *p = _block_of(key);
+		if (key < *p)
+			return 0;
+		size_t b = p - m_block_keys.data();
+		return b * block + _block_lower_bound(b, key);
+	}
+
+	/**
+	 * \brief the block whose first key is the last one not greater than key, or the first block
+	 *		The block keys are the 1st, (block+1)th, ... key, so an interpolation guess which lands
+	 *		in the right block is almost never equal to key. The adaptive offset of a
+	 *		search_context would take every such "miss" as a reason to correct the next guess,
+	 *		so the guess is used as-is and only corrected by scanning from it.
+	 */
+	inline const K *_block_of(const K &key) const {
+		double idx = search_type::_interpolate(key);
+		const K *rc = search_type::m_front + (size_t)std::min(std::max(idx, 0.0), (double)(search_type::m_size - 1));
+		if (key < *rc)
+			return search_type::_scan_backward(rc, key);
+		if (rc == search_type::m_back || key < rc[1])
+			return rc;
+		rc = search_type::_scan_forward(rc + 1, key);
+		return key < *rc ? rc - 1 : rc;
+	}
+
+	inline void _refresh() {
+		search_type::_refresh(m_block_keys.data(), m_block_keys.size());
+	}
+
+private:
+	/// first key of every compressed block, searched by the interpolation search
+	std::vector<K> m_block_keys;
+	/// decoding parameters of every compressed block
+	std::vector<block_header> m_blocks;
+	/// bit-packed residuals of all compressed blocks
+	std::vector<uint64_t> m_bits;
+	/// number of bits used in m_bits
+	uint64_t m_bit_count = 0;
+	/// uncompressed keys of the last, incomplete block
+	std::vector<K> m_tail;
+	/// value column
+	std::vector<V> m_values;
+};
+
+#endif /* __compressed_tuple_vector_h */
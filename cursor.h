@@ -0,0 +1,99 @@
+/**
+ * \file	cursor.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __cursor_h
+#define __cursor_h
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "asof_join.h"
+
+/**
+ * \brief position in a timeseries that follows an increasing stream of keys, e.g. the clock of a
+ *		backtest asking for the latest value at or before t
+ *		advance_to(key) gallops forward from the previous position with asof_advance(), so
+ *		moving d elements costs O(log d) and a monotone stream of queries costs amortised O(1)
+ *		per query when the keys are about as dense as the series. A key before the previous one
+ *		falls back to a full search with seek(). The position is kept as an index, so the
+ *		container may grow by appends while the cursor is in use, but it must not be modified
+ *		in any other way. Each cursor has its own search context, so several cursors can be
+ *		used from different threads on the same container.
+ * \tparam C tuple_vector, columnar_tuple_vector, mapped_tuple_vector or anything else with
+ *		random access iterators, sorted by key, and lower_bound(key, ctx)
+ */
+template<typename C>
+class tuple_cursor {
+	typedef typename std::decay<decltype(std::declval<const C &>().begin()->first)>::type K;
+public:
+	typedef typename C::const_iterator							const_iterator;
+	typedef typename C::context_type							context_type;
+
+	explicit tuple_cursor(const C &c) : m_c(&c) { }
+
+	/**
+	 * \brief move to the first element with a key not less than key, galloping forward from the
+	 *		current position unless key is less than the one of the previous call
+	 * \return the element, or end() if there is none
+	 */
+	inline const_iterator advance_to(const K &key) {
+		if (!m_valid || key < m_key)
+			return seek(key);
+		m_key = key;
+		const auto first = m_c->begin();
+		const_iterator pos = asof_advance(first + m_idx, m_c->end(), [&key](const decltype(*first) &e) { return e.first < key; });
+		m_idx = pos - first;
+		return pos;
+	}
+	/// move to the first element with a key not less than key with a full search
+	inline const_iterator seek(const K &key) {
+		const_iterator pos = m_c->lower_bound(key, m_ctx);
+		m_key = key;
+		m_idx = pos - m_c->begin();
+		m_valid = true;
+		return pos;
+	}
+	/**
+	 * \brief advance_to(key) and return the last element with a key not greater than key,
+	 *		i.e. the value as of key
+	 * \return the element, or end() if all elements are after key
+	 */
+	inline const_iterator latest(const K &key) {
+		const_iterator pos = advance_to(key);
+		if (pos != m_c->end() && !(key < pos->first))
+			return pos;
+		return pos == m_c->begin() ? m_c->end() : pos - 1;
+	}
+	/// forget the position, the next advance_to() does a full search
+	inline void reset() noexcept { m_valid = false; }
+
+	/// element at the current position, end() if past the last element or before any search
+	inline const_iterator position() const { return m_valid ? m_c->begin() + m_idx : m_c->end(); }
+	/// index of the current position
+	inline size_t index() const noexcept { return m_valid ? m_idx : m_c->size(); }
+	inline const_iterator end() const { return m_c->end(); }
+	inline const C &container() const noexcept { return *m_c; }
+	inline const context_type &context() const noexcept { return m_ctx; }
+
+private:
+	const C *m_c;
+	/// context of the full searches
+	context_type m_ctx;
+	/// key of the last call and index of the first element not less than it
+	K m_key = K();
+	size_t m_idx = 0;
+	bool m_valid = false;
+};
+
+/// cursor over c, e.g. auto cur = make_cursor(tv);
+template<typename C>
+inline tuple_cursor<C> make_cursor(const C &c)
+{
+	return tuple_cursor<C>(c);
+}
+
+#endif /* __cursor_h */
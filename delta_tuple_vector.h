@@ -0,0 +1,269 @@
+/**
+ * \file	delta_tuple_vector.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __delta_tuple_vector_h
+#define __delta_tuple_vector_h
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "tuple_vector.h"
+
+/// default number of late elements delta_tuple_vector buffers before merging them
+#ifndef TUPLE_VECTOR_DELTA_SIZE
+#define TUPLE_VECTOR_DELTA_SIZE 4096
+#endif
+
+/**
+ * \brief Bidirectional iterator over a delta_tuple_vector, walking the main series and the
+ *		delta buffer side by side in key order, like one step of a merge.
+ * \tparam C the container type, const for a const_iterator
+ */
+template<typename C>
+class delta_iterator {
+	typedef typename std::remove_const<C>::type container_type;
+public:
+	typedef std::bidirectional_iterator_tag									iterator_category;
+	typedef typename container_type::value_type								value_type;
+	typedef std::ptrdiff_t													difference_type;
+	typedef typename std::conditional<std::is_const<C>::value, const value_type, value_type>::type	&reference;
+	typedef typename std::conditional<std::is_const<C>::value, const value_type, value_type>::type	*pointer;
+
+	delta_iterator() { }
+	/// iterator at main element i and delta element j
+	delta_iterator(C *c, size_t i, size_t j) : m_c(c), m_i(i), m_j(j) { }
+	/// allow conversion from iterator to const_iterator
+	template<typename D, typename = typename std::enable_if<std::is_same<const D, C>::value && !std::is_same<D, C>::value>::type>
+	delta_iterator(const delta_iterator<D> &it) : m_c(it.container()), m_i(it.main_index()), m_j(it.delta_index()) { }
+
+	inline reference operator*() const { return _delta() ? m_c->_delta_at(m_j) : m_c->_main_at(m_i); }
+	inline pointer operator->() const { return &**this; }
+
+	inline delta_iterator &operator++() {
+		if (_delta())
+			++m_j;
+		else
+			++m_i;
+		return *this;
+	}
+	inline delta_iterator &operator--() {
+		// step back to the larger of the two elements before the current position
+		if (m_j > 0 && (m_i == 0 || m_c->_main_at(m_i - 1).first < m_c->_delta_at(m_j - 1).first))
+			--m_j;
+		else
+			--m_i;
+		return *this;
+	}
+	inline delta_iterator operator++(int) { delta_iterator it(*this); ++*this; return it; }
+	inline delta_iterator operator--(int) { delta_iterator it(*this); --*this; return it; }
+
+	inline bool operator==(const delta_iterator &it) const { return m_i == it.m_i && m_j == it.m_j; }
+	inline bool operator!=(const delta_iterator &it) const { return !(*this == it); }
+
+	inline C *container() const { return m_c; }
+	inline size_t main_index() const { return m_i; }
+	inline size_t delta_index() const { return m_j; }
+
+private:
+	/// true if the current element is the one in the delta buffer
+	inline bool _delta() const {
+		return m_j < m_c->delta_size() && (m_i == m_c->main().size() || m_c->_delta_at(m_j).first < m_c->_main_at(m_i).first);
+	}
+
+	C *m_c = nullptr;
+	size_t m_i = 0, m_j = 0;
+};
+
+/**
+ * \brief tuple_vector with a small sorted buffer for late elements, like the memtable of an
+ *		LSM tree. Appends in key order go straight to the main series. An insert() of an
+ *		element older than the newest one would shift all following elements of the main
+ *		series and make it recompute its interpolation line, so it goes into the delta buffer
+ *		instead. Once the buffer holds more than max_delta elements, or on compact(), it is
+ *		merged into the main series in one linear pass (see tuple_vector::merge()).
+ *		Lookups and iteration see the main series and the buffer as one series: find() and
+ *		lower_bound() run the interpolation search over the main series and a binary search
+ *		over the buffer, which is skipped while the buffer is empty.
+ * \tparam K A datetime type, e.g. time_t, boost::posix_time::ptime or similar.
+ * \tparam V A value type, can be whatever is appropriate for the use-case.
+ * \tparam Stats lookup statistics policy of the main series, no_search_stats (default) or search_stats
+ */
+template<typename K, typename V, typename Stats = no_search_stats>
+class delta_tuple_vector {
+	template<typename C> friend class delta_iterator;
+public:
+	typedef std::pair<K,V>										value_type;
+	typedef tuple_vector<K, V, Stats>							main_type;
+	typedef delta_iterator<delta_tuple_vector>					iterator;
+	typedef delta_iterator<const delta_tuple_vector>			const_iterator;
+	typedef size_t												size_type;
+	typedef typename main_type::context_type					context_type;
+
+	/// \param max_delta number of buffered elements which triggers a merge
+	explicit delta_tuple_vector(size_t max_delta = TUPLE_VECTOR_DELTA_SIZE) : m_max_delta(max_delta) { }
+
+	// Capacity
+	inline size_type size() const noexcept { return m_main.size() + m_delta.size(); }
+	inline bool empty() const noexcept { return size() == 0; }
+	/// number of elements in the delta buffer
+	inline size_type delta_size() const noexcept { return m_delta.size(); }
+	/// number of buffered elements which triggers a merge
+	inline size_type max_delta() const noexcept { return m_max_delta; }
+	inline void max_delta(size_type n) { m_max_delta = n; }
+	inline void reserve(size_type n) { m_main.reserve(n); }
+
+	// Modifying operations.
+	void clear() noexcept {
+		m_main.clear();
+		m_delta.clear();
+	}
+	/// append an element, which must have a key greater than all others
+	template <typename... Args> inline void emplace_back(Args&&... args) {
+		m_main.emplace_back(std::forward<Args>(args)...);
+	}
+	/**
+	 * \brief insert an element anywhere in the series, elements older than the newest one are
+	 *		buffered, see above
+	 * \return false if there already is an element with that key, which is left unchanged
+	 */
+	bool insert(const value_type &val) {
+		if (m_main.empty() || m_main.back().first < val.first) {
+			m_main.emplace_back(val);
+			return true;
+		}
+		if (m_main.find(val.first) != m_main.end())
+			return false;
+		auto pos = std::lower_bound(m_delta.begin(), m_delta.end(), val.first, _less());
+		if (pos != m_delta.end() && pos->first == val.first)
+			return false;
+		m_delta.insert(pos, val);
+		if (m_delta.size() > m_max_delta)
+			compact();
+		return true;
+	}
+	/// merge the delta buffer into the main series
+	void compact() {
+		m_main.merge(m_delta.begin(), m_delta.end());
+		m_delta.clear();
+	}
+
+	// Iterators
+	inline iterator begin() noexcept { return iterator(this, 0, 0); }
+	inline iterator end() noexcept { return iterator(this, m_main.size(), m_delta.size()); }
+	inline const_iterator begin() const noexcept { return const_iterator(this, 0, 0); }
+	inline const_iterator end() const noexcept { return const_iterator(this, m_main.size(), m_delta.size()); }
+	inline const_iterator cbegin() const noexcept { return begin(); }
+	inline const_iterator cend() const noexcept { return end(); }
+
+	// Access operations
+	inline iterator at(const K &key) {
+		auto pos = find(key);
+		if (pos == end())
+			throw std::out_of_range("iterator delta_tuple_vector::at(const K &key)");
+		return pos;
+	}
+	inline const_iterator at(const K &key) const {
+		auto pos = find(key);
+		if (pos == end())
+			throw std::out_of_range("const_iterator delta_tuple_vector::at(const K &key) const");
+		return pos;
+	}
+	inline const_iterator at(const K &key, context_type &ctx) const {
+		auto pos = find(key, ctx);
+		if (pos == end())
+			throw std::out_of_range("const_iterator delta_tuple_vector::at(const K &key) const");
+		return pos;
+	}
+	inline iterator find(const K &key) {
+		auto p = _find(key, [this](const K &k) { return m_main.find(k); }, [this](const K &k) { return m_main.lower_bound(k); });
+		return iterator(this, p.first, p.second);
+	}
+	inline const_iterator find(const K &key) const {
+		const main_type &m = m_main;
+		auto p = _find(key, [&m](const K &k) { return m.find(k); }, [&m](const K &k) { return m.lower_bound(k); });
+		return const_iterator(this, p.first, p.second);
+	}
+	/// find() using the given search context, safe to call from several threads at once
+	inline const_iterator find(const K &key, context_type &ctx) const {
+		const main_type &m = m_main;
+		auto p = _find(key, [&m,&ctx](const K &k) { return m.find(k, ctx); }, [&m,&ctx](const K &k) { return m.lower_bound(k, ctx); });
+		return const_iterator(this, p.first, p.second);
+	}
+	inline iterator lower_bound(const K &key) {
+		return iterator(this, m_main.lower_bound(key) - m_main.begin(), _delta_lower_bound(key));
+	}
+	inline const_iterator lower_bound(const K &key) const {
+		const main_type &m = m_main;
+		return const_iterator(this, m.lower_bound(key) - m.begin(), _delta_lower_bound(key));
+	}
+	/// lower_bound() using the given search context, safe to call from several threads at once
+	inline const_iterator lower_bound(const K &key, context_type &ctx) const {
+		return const_iterator(this, m_main.lower_bound(key, ctx) - m_main.begin(), _delta_lower_bound(key));
+	}
+	inline iterator upper_bound(const K &key) {
+		return iterator(this, m_main.upper_bound(key) - m_main.begin(), _delta_upper_bound(key));
+	}
+	inline const_iterator upper_bound(const K &key) const {
+		const main_type &m = m_main;
+		return const_iterator(this, m.upper_bound(key) - m.begin(), _delta_upper_bound(key));
+	}
+	/// upper_bound() using the given search context, safe to call from several threads at once
+	inline const_iterator upper_bound(const K &key, context_type &ctx) const {
+		return const_iterator(this, m_main.upper_bound(key, ctx) - m_main.begin(), _delta_upper_bound(key));
+	}
+
+	/// the main series, without the buffered elements
+	inline const main_type &main() const noexcept { return m_main; }
+	/// the delta buffer, sorted by key
+	inline const std::vector<value_type> &delta() const noexcept { return m_delta; }
+
+protected:
+	struct _less {
+		inline bool operator()(const value_type &a, const K &b) const { return a.first < b; }
+		inline bool operator()(const K &a, const value_type &b) const { return a < b.first; }
+	};
+
+	inline value_type &_main_at(size_t i) { return m_main.begin()[i]; }
+	inline const value_type &_main_at(size_t i) const { return m_main.begin()[i]; }
+	inline value_type &_delta_at(size_t j) { return m_delta[j]; }
+	inline const value_type &_delta_at(size_t j) const { return m_delta[j]; }
+
+	inline size_t _delta_lower_bound(const K &key) const {
+		return m_delta.empty() ? 0 : std::lower_bound(m_delta.begin(), m_delta.end(), key, _less()) - m_delta.begin();
+	}
+	inline size_t _delta_upper_bound(const K &key) const {
+		return m_delta.empty() ? 0 : std::upper_bound(m_delta.begin(), m_delta.end(), key, _less()) - m_delta.begin();
+	}
+
+	/**
+	 * \brief positions in the main series and the delta buffer of the element with key
+	 * \return (main index, delta index), or the end position if key was not found
+	 */
+	template<typename Find, typename LowerBound>
+	inline std::pair<size_t, size_t> _find(const K &key, Find find, LowerBound lower_bound) const {
+		const size_t j = _delta_lower_bound(key);
+		auto it = find(key);
+		if (it != m_main.end())
+			return std::make_pair((size_t)(it - m_main.begin()), j);
+		if (j < m_delta.size() && m_delta[j].first == key)
+			return std::make_pair((size_t)(lower_bound(key) - m_main.begin()), j);
+		return std::make_pair(m_main.size(), m_delta.size());
+	}
+
+private:
+	/// main series, only ever appended to between merges
+	main_type m_main;
+	/// late elements, sorted by key, none of which is in the main series
+	std::vector<value_type> m_delta;
+	/// number of buffered elements which triggers a merge
+	size_t m_max_delta;
+};
+
+#endif /* __delta_tuple_vector_h */
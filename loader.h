@@ -0,0 +1,423 @@
+/**
+ * \file	loader.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __loader_h
+#define __loader_h
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "tuple_vector.h"
+#include "bulk_load.h"
+
+/// number of bytes every thread of load_text() and load_binary() parses per batch
+#ifndef TUPLE_VECTOR_LOAD_CHUNK
+#define TUPLE_VECTOR_LOAD_CHUNK (4 * 1024 * 1024)
+#endif
+
+/**
+ * \brief field_parser parses one field of a delimited text file, see load_text()
+ *		parse(first, last, x) parses the field starting at first, which is followed by a
+ *		delimiter, a line end or a NUL character before last at the latest, and returns a
+ *		pointer past the parsed characters, or nullptr if there is no valid value.
+ *		Arithmetic types are supported out of the box. Anything else is read as the 64 bit
+ *		integer of its key_codec, e.g. nanoseconds since the epoch for a std::chrono time_point,
+ *		unless there is a template specialisation, just like for key<K>.
+ * \tparam T field type
+ */
+template<typename T, typename = void>
+struct field_parser;
+
+template<typename T>
+struct field_parser<T, typename std::enable_if<std::is_integral<T>::value>::type> {
+	static inline const char *parse(const char *first, const char *last, T &x) {
+		bool neg = false;
+		if (first < last && (*first == '-' || *first == '+'))
+			neg = *first++ == '-';
+		if (neg && !std::is_signed<T>::value)
+			return nullptr;
+		const char *p = first;
+		uint64_t v = 0;
+		for (; p < last && (unsigned)(*p - '0') < 10; ++p)
+			if (__builtin_mul_overflow(v, (uint64_t)10, &v) || __builtin_add_overflow(v, (uint64_t)(*p - '0'), &v))
+				return nullptr;
+		if (p == first)
+			return nullptr;
+		typedef typename std::make_unsigned<T>::type U;
+		if (v > (uint64_t)std::numeric_limits<U>::max() >> std::is_signed<T>::value) {
+			// only the most negative value of a signed type is one larger than its maximum
+			if (!neg || v - 1 > (uint64_t)std::numeric_limits<T>::max())
+				return nullptr;
+		}
+		x = neg ? (T)(0 - (U)v) : (T)v;
+		return p;
+	}
+};
+
+template<typename T>
+struct field_parser<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+	/**
+	 * Plain decimals like 101.25 or 1.5e-3 with up to 19 significant digits and a decimal
+	 * exponent of at most 22 are exactly representable as m * 10^e with an integral m below
+	 * 2^53, which one multiplication or division rounds correctly. Everything else goes to
+	 * strtod(), which relies on the field being followed by a non-numeric character.
+	 */
+	static inline const char *parse(const char *first, const char *last, T &x) {
+		static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+		const char *p = first;
+		bool neg = false;
+		if (p < last && (*p == '-' || *p == '+'))
+			neg = *p++ == '-';
+		uint64_t m = 0;
+		int digits = 0, exp = 0;
+		for (; p < last && (unsigned)(*p - '0') < 10; ++p, ++digits)
+			m = m * 10 + (*p - '0');
+		if (p < last && *p == '.') {
+			for (++p; p < last && (unsigned)(*p - '0') < 10; ++p, ++digits, --exp)
+				m = m * 10 + (*p - '0');
+		}
+		if (digits == 0)
+			return _slow(first, last, x);
+		if (p < last && (*p == 'e' || *p == 'E')) {
+			int e;
+			const char *q = field_parser<int>::parse(p + 1, last, e);
+			if (!q || e < -400 || e > 400)
+				return _slow(first, last, x);
+			exp += e;
+			p = q;
+		}
+		if (digits > 19 || m > ((uint64_t)1 << 53) || exp < -22 || exp > 22)
+			return _slow(first, last, x);
+		double d = exp < 0 ? (double)m / pow10[-exp] : (double)m * pow10[exp];
+		x = (T)(neg ? -d : d);
+		return p;
+	}
+
+private:
+	static inline const char *_slow(const char *first, const char *last, T &x) {
+		char *end;
+		double d = std::strtod(first, &end);
+		if (end == first || end > last)
+			return nullptr;
+		x = (T)d;
+		return end;
+	}
+};
+
+template<typename T, typename>
+struct field_parser {
+	static inline const char *parse(const char *first, const char *last, T &x) {
+		int64_t code;
+		first = field_parser<int64_t>::parse(first, last, code);
+		if (first)
+			x = key_codec<T>::decode(code);
+		return first;
+	}
+};
+
+/// layout of a delimited text file for load_text()
+struct text_format {
+	char delimiter = '\t';		///< field delimiter, e.g. '\t' or ','
+	size_t key_column = 0;		///< 0-based column of the key
+	size_t value_column = 1;	///< 0-based column of the value
+	size_t header_lines = 0;	///< number of lines to skip at the beginning of the file
+};
+
+/// layout of the fixed-size records of a binary file for load_binary()
+struct binary_format {
+	size_t record_size;		///< bytes per record
+	size_t key_offset;		///< offset of the key in a record
+	size_t value_offset;	///< offset of the value in a record
+
+	/// records made of a K immediately followed by a V, without padding
+	template<typename K, typename V>
+	static binary_format packed() { return binary_format{sizeof(K) + sizeof(V), 0, sizeof(K)}; }
+};
+
+/**
+ * \brief reads a file in batches of about threads * TUPLE_VECTOR_LOAD_CHUNK bytes on a thread
+ *		of its own, so the next batch is read while the current one is parsed
+ */
+class load_reader {
+public:
+	/**
+	 * \param path file to read
+	 * \param align batches are cut after the last occurrence of this character (text files),
+	 *		or to a multiple of record bytes (binary files) if it is 0
+	 */
+	load_reader(const std::string &path, size_t batch, char align, size_t record = 1)
+		: m_is(path, std::ios::binary), m_batch(batch), m_align(align), m_record(record) {
+		if (!m_is)
+			throw std::runtime_error("cannot open " + path);
+		m_is.seekg(0, std::ios::end);
+		m_size = (size_t)m_is.tellg();
+		m_is.seekg(0, std::ios::beg);
+		if (!m_align)
+			m_batch = std::max(m_record, m_batch / m_record * m_record);
+		m_io = std::thread(&load_reader::_read, this);
+	}
+	~load_reader() {
+		if (m_io.joinable())
+			m_io.join();
+	}
+
+	/// size of the file in bytes
+	size_t size() const { return m_size; }
+
+	/**
+	 * \brief wait for the next batch and start reading the one after it
+	 * \param buf receives the batch followed by a NUL character, which is not part of it
+	 * \return false at the end of the file
+	 */
+	bool next(std::vector<char> &buf) {
+		m_io.join();
+		if (m_next.size() == 1 && m_carry.empty())
+			return false;
+		buf.swap(m_next);
+		m_io = std::thread(&load_reader::_read, this);
+		return true;
+	}
+
+private:
+	void _read() {
+		m_next.assign(m_carry.begin(), m_carry.end());
+		m_carry.clear();
+		size_t have = m_next.size();
+		for (;;) {
+			m_next.resize(have + m_batch);
+			m_is.read(m_next.data() + have, m_batch);
+			have += (size_t)m_is.gcount();
+			m_next.resize(have);
+			if (!m_is)
+				break;		// end of file
+			// more to come, hand the incomplete line or record over to the next batch
+			size_t cut = have;
+			if (m_align) {
+				while (cut > 0 && m_next[cut - 1] != m_align)
+					--cut;
+				if (cut == 0)
+					continue;	// line longer than a batch, keep on reading
+			} else {
+				cut -= cut % m_record;
+			}
+			m_carry.assign(m_next.begin() + cut, m_next.end());
+			m_next.resize(cut);
+			break;
+		}
+		m_next.push_back('\0');
+	}
+
+	std::ifstream m_is;
+	size_t m_size = 0, m_batch;
+	char m_align;
+	size_t m_record;
+	std::vector<char> m_next, m_carry;
+	std::thread m_io;
+};
+
+/**
+ * \brief load a tuple_vector from a delimited text file, e.g. tab separated like the files in results/
+ *		or a CSV file, replacing its previous contents
+ *		The file is read in batches on a thread of its own while the previous batch is parsed,
+ *		see load_reader. Every batch is cut at line boundaries into one piece per thread and
+ *		parsed in two parallel passes: the first one counts the records of every piece, so the
+ *		second one can parse them with field_parser directly into their final position, and
+ *		checks that the keys are strictly increasing. The container is reserved once, estimated
+ *		from the size of the file and the average record length of the first batch.
+ *		Empty lines and a '\r' at the end of a line are ignored, anything else that is not a
+ *		valid record is an error.
+ * \param out container to fill
+ * \param path file to read
+ * \param fmt layout of the file
+ * \param threads number of threads parsing, 0 for one per core
+ * \throw std::runtime_error if the file cannot be opened, a record is malformed or the keys
+ *		are not strictly increasing, with the 1-based number of the offending record
+ */
+template<typename K, typename V, typename Stats, typename Allocator>
+void load_text(tuple_vector<K,V,Stats,Allocator> &out, const std::string &path, const text_format &fmt = text_format(),
+	unsigned threads = 0)
+{
+	typedef std::pair<K,V> value_type;
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	const char delim = fmt.delimiter;
+	const size_t ncols = std::max(fmt.key_column, fmt.value_column) + 1;
+
+	// parse one line [p, eol) into e, false if it is malformed
+	const auto parse_line = [&fmt, delim, ncols](const char *p, const char *eol, value_type &e) {
+		for (size_t col = 0; col < ncols; ++col) {
+			if (col == fmt.key_column || col == fmt.value_column) {
+				p = col == fmt.key_column ? field_parser<K>::parse(p, eol, e.first) : field_parser<V>::parse(p, eol, e.second);
+				if (!p || (p < eol && *p != delim && !(*p == '\r' && p + 1 == eol)))
+					return false;
+			} else {
+				p = (const char *)std::memchr(p, delim, eol - p);
+				if (!p)
+					return false;
+			}
+			if (col + 1 < ncols) {
+				if (p == eol || *p != delim)
+					return false;
+				++p;
+			}
+		}
+		return true;
+	};
+	// end of the line starting at p
+	const auto line_end = [](const char *p, const char *last) {
+		const char *eol = (const char *)std::memchr(p, '\n', last - p);
+		return eol ? eol : last;
+	};
+	const auto is_empty = [](const char *p, const char *eol) { return p == eol || (p + 1 == eol && *p == '\r'); };
+
+	load_reader reader(path, threads * (size_t)TUPLE_VECTOR_LOAD_CHUNK, '\n');
+	std::vector<value_type, Allocator> buf(out.get_allocator());
+	std::vector<char> batch;
+	size_t header = fmt.header_lines, bytes = 0;
+	bool reserved = false;
+	while (reader.next(batch)) {
+		const char *first = batch.data(), *last = batch.data() + batch.size() - 1;
+		for (; header && first < last; --header)
+			first = std::min(last, line_end(first, last) + 1);
+		bytes += last - first;
+
+		// cut the batch into one piece per thread at line boundaries
+		std::vector<const char *> cut(threads + 1, last);
+		cut[0] = first;
+		for (unsigned t = 1; t < threads; ++t) {
+			const char *p = std::max(cut[t - 1], first + (last - first) * t / threads);
+			cut[t] = p == first ? p : std::min(last, line_end(p - 1, last) + 1);
+		}
+
+		// 1. count the records of every piece
+		std::vector<size_t> offset(threads + 1, 0);
+		bulk_parallel(threads, [&](unsigned t) {
+			size_t n = 0;
+			for (const char *p = cut[t], *eol; p < cut[t + 1]; p = eol + 1) {
+				eol = line_end(p, cut[t + 1]);
+				n += !is_empty(p, eol);
+			}
+			offset[t + 1] = n;
+		});
+		for (unsigned t = 0; t < threads; ++t)
+			offset[t + 1] += offset[t];
+		const size_t base = buf.size();
+		if (!reserved && offset[threads]) {
+			// reserve once with a little headroom, estimated from the first batch
+			const double per_record = (double)bytes / offset[threads];
+			buf.reserve((size_t)(reader.size() / per_record * 1.02) + offset[threads]);
+			reserved = true;
+		}
+		buf.resize(base + offset[threads]);
+
+		// 2. parse every piece into its final position and check the keys
+		std::vector<size_t> bad(threads, std::numeric_limits<size_t>::max());
+		std::vector<char> unordered(threads, 0);
+		bulk_parallel(threads, [&](unsigned t) {
+			value_type *e = buf.data() + base + offset[t];
+			for (const char *p = cut[t], *eol; p < cut[t + 1]; p = eol + 1) {
+				eol = line_end(p, cut[t + 1]);
+				if (is_empty(p, eol))
+					continue;
+				if (!parse_line(p, eol, *e)) {
+					bad[t] = e - buf.data();
+					return;
+				}
+				if (e != buf.data() + base + offset[t] && !(e[-1].first < e->first)) {
+					bad[t] = e - buf.data();
+					unordered[t] = 1;
+					return;
+				}
+				++e;
+			}
+		});
+		for (unsigned t = 0; t < threads; ++t) {
+			const size_t b = base + offset[t];
+			if (bad[t] == std::numeric_limits<size_t>::max() && b > 0 && offset[t + 1] > offset[t] && !(buf[b - 1].first < buf[b].first)) {
+				bad[t] = b;
+				unordered[t] = 1;
+			}
+			if (bad[t] != std::numeric_limits<size_t>::max())
+				throw std::runtime_error("load_text: " + path + (unordered[t] ? ": key not strictly increasing in record "
+					: ": malformed record ") + std::to_string(bad[t] + 1));
+		}
+	}
+	out = std::move(buf);
+}
+
+/**
+ * \brief load a tuple_vector from a file of fixed-size binary records, replacing its previous
+ *		contents
+ *		The number of records follows from the size of the file, so the container is allocated
+ *		once. Batches are read on a thread of their own (see load_reader) while the previous
+ *		batch is copied into place by several threads, which also check that the keys are
+ *		strictly increasing. Keys and values are copied byte by byte in native byte order.
+ * \param out container to fill
+ * \param path file to read
+ * \param fmt layout of the records, defaults to a K immediately followed by a V
+ * \param threads number of threads, 0 for one per core
+ * \throw std::runtime_error if the file cannot be opened, its size is not a multiple of the
+ *		record size or the keys are not strictly increasing
+ */
+template<typename K, typename V, typename Stats, typename Allocator>
+void load_binary(tuple_vector<K,V,Stats,Allocator> &out, const std::string &path,
+	const binary_format &fmt = binary_format::packed<K,V>(), unsigned threads = 0)
+{
+	static_assert(std::is_trivially_copyable<K>::value && std::is_trivially_copyable<V>::value,
+		"load_binary() needs trivially copyable keys and values");
+	typedef std::pair<K,V> value_type;
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	if (fmt.record_size < fmt.key_offset + sizeof(K) || fmt.record_size < fmt.value_offset + sizeof(V))
+		throw std::runtime_error("load_binary: record too small for key and value");
+
+	load_reader reader(path, threads * (size_t)TUPLE_VECTOR_LOAD_CHUNK, 0, fmt.record_size);
+	if (reader.size() % fmt.record_size)
+		throw std::runtime_error("load_binary: size of " + path + " is not a multiple of the record size");
+	std::vector<value_type, Allocator> buf(reader.size() / fmt.record_size, out.get_allocator());
+	std::vector<char> batch;
+	size_t base = 0;
+	while (reader.next(batch)) {
+		const size_t n = (batch.size() - 1) / fmt.record_size;
+		if (base + n > buf.size())
+			throw std::runtime_error("load_binary: " + path + " changed while reading");
+		std::vector<char> unordered(threads, 0);
+		bulk_parallel(threads, [&](unsigned t) {
+			const size_t b = n * t / threads, e = n * (t + 1) / threads;
+			const char *rec = batch.data() + b * fmt.record_size;
+			value_type *dst = buf.data() + base + b;
+			for (size_t i = b; i < e; ++i, rec += fmt.record_size, ++dst) {
+				std::memcpy(&dst->first, rec + fmt.key_offset, sizeof(K));
+				std::memcpy(&dst->second, rec + fmt.value_offset, sizeof(V));
+				if (i > b && !(dst[-1].first < dst->first))
+					unordered[t] = 1;
+			}
+		});
+		// the first key of every slice is checked against the one before it once all are written
+		for (unsigned t = 0; t < threads; ++t) {
+			const size_t b = base + n * t / threads;
+			if (b > 0 && b < base + n && !(buf[b - 1].first < buf[b].first))
+				unordered[t] = 1;
+		}
+		if (std::find(unordered.begin(), unordered.end(), 1) != unordered.end())
+			throw std::runtime_error("load_binary: keys in " + path + " not strictly increasing");
+		base += n;
+	}
+	buf.resize(base);
+	out = std::move(buf);
+}
+
+#endif /* __loader_h */
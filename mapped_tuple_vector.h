@@ -0,0 +1,375 @@
+/**
+ * \file	mapped_tuple_vector.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __mapped_tuple_vector_h
+#define __mapped_tuple_vector_h
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "columnar_tuple_vector.h"
+
+/**
+ * On-disk format of a timeseries with trivially copyable K and V, all numbers are stored in the
+ * native byte order of the machine writing the file:
+ *
+ *	offset			size				contents
+ *	0				72					mapped_file_header
+ *	key_offset		count * sizeof(K)	key column, strictly increasing
+ *	value_offset	count * sizeof(V)	value column
+ *	index_offset	segments * 24		learned index segments (optional), each consisting of
+ *										the first key as double, the slope as double and the
+ *										index of the first element as uint64_t
+ *	skey_offset		segments * sizeof(K) first key of every segment (optional)
+ *
+ * All sections start at a multiple of 64 bytes. A file without a learned index has
+ * index_segments == 0, in which case the reader uses the interpolation search.
+ */
+struct mapped_file_header {
+	/// "TUPLEVEC"
+	char magic[8];
+	/// format version, currently 1
+	uint32_t version;
+	/// sizeof(K) of the writer
+	uint32_t key_size;
+	/// sizeof(V) of the writer
+	uint32_t value_size;
+	/// maximum error of the learned index, 0 if there is none
+	uint32_t index_epsilon;
+	/// number of elements
+	uint64_t count;
+	/// byte offset of the key column
+	uint64_t key_offset;
+	/// byte offset of the value column
+	uint64_t value_offset;
+	/// number of learned index segments
+	uint64_t index_segments;
+	/// byte offset of the learned index segments
+	uint64_t index_offset;
+	/// byte offset of the first key of every segment
+	uint64_t skey_offset;
+};
+
+static_assert(sizeof(mapped_file_header) == 72, "unexpected mapped_file_header layout");
+
+/**
+ * \brief A read-only, zero-copy view of a timeseries file (see mapped_file_header) which is
+ *		mmap()ed into memory. It offers the same find(), lower_bound(), at() and iteration as
+ *		columnar_tuple_vector. Nothing is read at startup apart from the header and the learned
+ *		index, the columns are paged in on demand and processes mapping the same file share
+ *		the page cache.
+ *		Use write() to create such a file from a tuple_vector or columnar_tuple_vector.
+ * \tparam K A trivially copyable datetime type, e.g. time_t.
+ * \tparam V A trivially copyable value type.
+ * \tparam Stats lookup statistics policy, no_search_stats (default) or search_stats
+ */
+template<typename K, typename V, typename Stats = no_search_stats>
+class mapped_tuple_vector : public interpolation_search<K, K, Stats> {
+	static_assert(std::is_trivially_copyable<K>::value, "mapped_tuple_vector needs a trivially copyable key type");
+	static_assert(std::is_trivially_copyable<V>::value, "mapped_tuple_vector needs a trivially copyable value type");
+	typedef interpolation_search<K, K, Stats> search_type;
+	using search_type::m_ctx;
+	using search_type::m_size;
+public:
+	typedef std::pair<K,V>										value_type;
+	typedef columnar_iterator<K, V, true>						const_iterator;
+	typedef const_iterator										iterator;
+	typedef typename const_iterator::reference					const_reference;
+	typedef size_t												size_type;
+	typedef typename search_type::context_type					context_type;
+
+	mapped_tuple_vector() { }
+
+	/// map the given file, throws std::runtime_error if it cannot be mapped or is not a valid file
+	explicit mapped_tuple_vector(const std::string &path) { open(path); }
+
+	mapped_tuple_vector(const mapped_tuple_vector &) = delete;
+	mapped_tuple_vector &operator=(const mapped_tuple_vector &) = delete;
+
+	/// take over the mapping of x, which is left closed - the mapping stays where it is, so the
+	/// search state and the stored learned index remain valid without a _refresh()
+	mapped_tuple_vector(mapped_tuple_vector &&x) : search_type(x), m_addr(x.m_addr), m_length(x.m_length),
+		m_keys(x.m_keys), m_values(x.m_values) {
+		x.m_addr = nullptr;
+		x.close();
+	}
+	mapped_tuple_vector &operator=(mapped_tuple_vector &&x) {
+		if (this != &x) {
+			close();
+			search_type::operator=(x);
+			m_addr = x.m_addr;
+			m_length = x.m_length;
+			m_keys = x.m_keys;
+			m_values = x.m_values;
+			x.m_addr = nullptr;
+			x.close();
+		}
+		return *this;
+	}
+
+	~mapped_tuple_vector() { close(); }
+
+	/// map the given file, throws std::runtime_error if it cannot be mapped or is not a valid file
+	void open(const std::string &path) {
+		close();
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			throw std::runtime_error("mapped_tuple_vector::open(): cannot open " + path);
+		struct stat st;
+		if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(mapped_file_header)) {
+			::close(fd);
+			throw std::runtime_error("mapped_tuple_vector::open(): " + path + " is too small");
+		}
+		void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (addr == MAP_FAILED)
+			throw std::runtime_error("mapped_tuple_vector::open(): cannot map " + path);
+		m_addr = (const char *)addr;
+		m_length = st.st_size;
+
+		const mapped_file_header &h = *(const mapped_file_header *)m_addr;
+		if (memcmp(h.magic, "TUPLEVEC", 8) || h.version != 1 || h.key_size != sizeof(K) || h.value_size != sizeof(V)
+				|| !_fits<K>(h.key_offset, h.count) || !_fits<V>(h.value_offset, h.count)
+				|| !_fits<segment>(h.index_offset, h.index_segments)
+				|| !_fits<K>(h.skey_offset, h.index_segments)
+				|| !_valid_index(h)) {
+			close();
+			throw std::runtime_error("mapped_tuple_vector::open(): " + path + " is not a valid timeseries file");
+		}
+		m_keys = (const K *)(m_addr + h.key_offset);
+		m_values = (const V *)(m_addr + h.value_offset);
+		search_type::_refresh(m_keys, h.count);
+		if (h.index_segments) {
+			// use the stored learned index instead of building one from all keys
+			const segment *seg = (const segment *)(m_addr + h.index_offset);
+			const K *skey = (const K *)(m_addr + h.skey_offset);
+			search_type::m_epsilon = h.index_epsilon;
+			search_type::m_segments.assign(seg, seg + h.index_segments);
+			search_type::m_segment_keys.assign(skey, skey + h.index_segments);
+		}
+	}
+
+	/// unmap the file
+	void close() {
+		if (m_addr)
+			munmap((void *)m_addr, m_length);
+		m_addr = nullptr;
+		m_length = 0;
+		m_keys = nullptr;
+		m_values = nullptr;
+		search_type::drop_index();
+		search_type::_refresh(m_keys, 0);
+	}
+
+	/**
+	 * \brief write a timeseries file which can be mapped by mapped_tuple_vector
+	 * \param path name of the file to write
+	 * \param tv the timeseries, e.g. a tuple_vector<K,V> or columnar_tuple_vector<K,V>
+	 * \param epsilon maximum error of the learned index to store in the file, 0 for none - like
+	 *		build_index() this only pays off for keys with sessions, gaps or bursts, throws
+	 *		std::invalid_argument if it does not fit into mapped_file_header::index_epsilon
+	 */
+	template<typename C>
+	static void write(const std::string &path, const C &tv, size_t epsilon = 0) {
+		if (epsilon > std::numeric_limits<uint32_t>::max())
+			throw std::invalid_argument("mapped_tuple_vector::write(): epsilon " + std::to_string(epsilon) + " is too large");
+		std::vector<K> keys;
+		keys.reserve(tv.size());
+		for (const auto &it : tv)
+			keys.push_back(it.first);
+		key_index idx(keys, epsilon);
+
+		mapped_file_header h;
+		memset(&h, 0, sizeof(h));
+		memcpy(h.magic, "TUPLEVEC", 8);
+		h.version = 1;
+		h.key_size = sizeof(K);
+		h.value_size = sizeof(V);
+		h.index_epsilon = epsilon;
+		h.count = keys.size();
+		h.key_offset = _align(sizeof(h));
+		h.value_offset = _align(h.key_offset + h.count * sizeof(K));
+		h.index_segments = idx.segments().size();
+		h.index_offset = _align(h.value_offset + h.count * sizeof(V));
+		h.skey_offset = _align(h.index_offset + h.index_segments * sizeof(segment));
+
+		std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+		if (!ofs)
+			throw std::runtime_error("mapped_tuple_vector::write(): cannot create " + path);
+		_put(ofs, 0, &h, sizeof(h));
+		_put(ofs, h.key_offset, keys.data(), h.count * sizeof(K));
+		ofs.seekp(h.value_offset);
+		for (const auto &it : tv)
+			ofs.write((const char *)&it.second, sizeof(V));
+		_put(ofs, h.index_offset, idx.segments().data(), h.index_segments * sizeof(segment));
+		_put(ofs, h.skey_offset, idx.segment_keys().data(), h.index_segments * sizeof(K));
+		if (!ofs.flush())
+			throw std::runtime_error("mapped_tuple_vector::write(): cannot write " + path);
+	}
+
+	// Capacity
+	inline size_type size() const noexcept { return m_size; }
+	inline bool empty() const noexcept { return m_size == 0; }
+
+	// Iterators
+	inline const_iterator begin() const noexcept { return const_iterator(m_keys, m_values); }
+	inline const_iterator end() const noexcept { return begin() + m_size; }
+	inline const_iterator cbegin() const noexcept { return begin(); }
+	inline const_iterator cend() const noexcept { return end(); }
+
+	// Access operations
+	inline const_iterator at(const K &key) const {
+		return at(key, m_ctx);
+	}
+	inline const_iterator at(const K &key, context_type &ctx) const {
+		auto pos = find(key, ctx);
+		if (pos == end())
+			throw std::out_of_range("const_iterator mapped_tuple_vector::at(const K &key) const");
+		return pos;
+	}
+	inline const_reference operator[](size_t idx) const {
+		return const_reference(m_keys[idx], m_values[idx]);
+	}
+	inline const_reference operator[](const K &key) const {
+		return *lower_bound(key);
+	}
+	inline const_reference front() const { return *begin(); }
+	inline const_reference back() const { return *(end() - 1); }
+	inline const_iterator lower_bound(const K &key) const {
+		return lower_bound(key, m_ctx);
+	}
+	/// lower_bound() using the given search context, safe to call from several threads at once
+	inline const_iterator lower_bound(const K &key, context_type &ctx) const {
+		return begin() + (search_type::_lower_bound(key, ctx) - m_keys);
+	}
+	inline const_iterator find(const K &key) const {
+		return find(key, m_ctx);
+	}
+	/// find() using the given search context, safe to call from several threads at once
+	inline const_iterator find(const K &key, context_type &ctx) const {
+		return begin() + (search_type::_find(key, ctx) - m_keys);
+	}
+	/**
+	 * \brief find() for a whole range of sorted or unsorted keys
+	 * \param out receives the index of every key, size() if the key was not found
+	 */
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt find_many(InputIt first, InputIt last, OutputIt out) const {
+		return find_many(first, last, out, m_ctx);
+	}
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt find_many(InputIt first, InputIt last, OutputIt out, context_type &ctx) const {
+		return search_type::_search_many(first, last, out, true, ctx);
+	}
+	/**
+	 * \brief lower_bound() for a whole range of sorted or unsorted keys
+	 * \param out receives the index of every lower bound, size() if there is none
+	 */
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt lower_bound_many(InputIt first, InputIt last, OutputIt out) const {
+		return lower_bound_many(first, last, out, m_ctx);
+	}
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt lower_bound_many(InputIt first, InputIt last, OutputIt out, context_type &ctx) const {
+		return search_type::_search_many(first, last, out, false, ctx);
+	}
+	inline const_iterator upper_bound(const K &key) const {
+		return upper_bound(key, m_ctx);
+	}
+	/// upper_bound() using the given search context, safe to call from several threads at once
+	inline const_iterator upper_bound(const K &key, context_type &ctx) const {
+		return begin() + (search_type::_upper_bound(key, ctx) - m_keys);
+	}
+	inline std::pair<const_iterator, const_iterator> equal_range(const K &key) const {
+		return equal_range(key, m_ctx);
+	}
+	/// equal_range() using the given search context, safe to call from several threads at once
+	inline std::pair<const_iterator, const_iterator> equal_range(const K &key, context_type &ctx) const {
+		auto first = lower_bound(key, ctx);
+		return std::make_pair(first, first != end() && first->first == key ? first + 1 : first);
+	}
+
+	/// the mapped key column
+	inline const K *keys() const noexcept { return m_keys; }
+	/// the mapped value column
+	inline const V *values() const noexcept { return m_values; }
+
+protected:
+	typedef typename search_type::segment segment;
+	static_assert(sizeof(segment) == 24, "unexpected learned index segment layout");
+
+	/// helper to build the learned index over a key column before writing it
+	class key_index : public interpolation_search<K, K> {
+	public:
+		key_index(const std::vector<K> &keys, size_t epsilon) {
+			this->_refresh(keys.data(), keys.size());
+			if (epsilon)
+				this->build_index(epsilon);
+		}
+		const std::vector<segment> &segments() const { return this->m_segments; }
+		const std::vector<K> &segment_keys() const { return this->m_segment_keys; }
+	};
+
+	/// round up to the next multiple of 64
+	static inline uint64_t _align(uint64_t offset) { return (offset + 63) & ~(uint64_t)63; }
+
+	/**
+	 * \brief true if the section of n elements of type T at offset lies within the mapped file and
+	 *		is aligned for T, or is empty
+	 */
+	template<typename T>
+	inline bool _fits(uint64_t offset, uint64_t n) const {
+		if (!n)
+			return true;
+		// check the number of elements before multiplying, so a crafted count cannot wrap around
+		return offset % alignof(T) == 0 && offset <= m_length && n <= (m_length - offset) / sizeof(T);
+	}
+
+	/**
+	 * \brief true if the stored learned index can be searched without leaving the key column:
+	 *		finite segment keys and slopes, segment indices non-decreasing and not greater than
+	 *		count and segment keys sorted. The sections must already be known to fit.
+	 */
+	inline bool _valid_index(const mapped_file_header &h) const {
+		const segment *seg = (const segment *)(m_addr + h.index_offset);
+		const K *skey = (const K *)(m_addr + h.skey_offset);
+		for (uint64_t s = 0; s < h.index_segments; s++) {
+			if (!std::isfinite(seg[s].key) || !std::isfinite(seg[s].slope) || seg[s].index > h.count)
+				return false;
+			if (s && (seg[s].index < seg[s-1].index || skey[s] < skey[s-1]))
+				return false;
+		}
+		return true;
+	}
+
+	static inline void _put(std::ofstream &ofs, uint64_t offset, const void *data, size_t len) {
+		ofs.seekp(offset);
+		ofs.write((const char *)data, len);
+	}
+
+private:
+	/// start of the mapping
+	const char *m_addr = nullptr;
+	/// length of the mapping in bytes
+	size_t m_length = 0;
+	/// mapped key column, searched by find() and lower_bound()
+	const K *m_keys = nullptr;
+	/// mapped value column
+	const V *m_values = nullptr;
+};
+
+#endif /* __mapped_tuple_vector_h */
@@ -27,6 +27,8 @@ if (length(args) == 0)
 # iterator  1000    vector         684   0.62500   15.32300   0.68472    0.23855   0.48842
 # iterator  1000    map           5908   5.72200   16.55800   5.90823    0.99323   0.99661
 #   ...
+# the "bench" program writes the same columns with latencies per lookup in ns, followed by
+# p50, p99, p999, cache_misses and branch_misses, which are plotted into <test>_latency.png
 
 # read test results into table
 data <- read.table(args[1], header=TRUE, sep="\t")
@@ -42,4 +44,13 @@ for (t in unique(data$test)) {
 	p6 <- ggplot(d, aes(x=size, y=log(dev), colour=container)) + geom_line() + ggtitle("std-dev")
 	png(paste(t, ".png", sep=""), width = 1200, height = 600);
 	grid.arrange(p1, p2, p3, p4, p5, p6, ncol = 3);
+	if ("p50" %in% names(data)) {
+		q1 <- ggplot(d, aes(x=size, y=log(p50), colour=container)) + geom_line() + ggtitle("p50")
+		q2 <- ggplot(d, aes(x=size, y=log(p99), colour=container)) + geom_line() + ggtitle("p99")
+		q3 <- ggplot(d, aes(x=size, y=log(p999), colour=container)) + geom_line() + ggtitle("p99.9")
+		q4 <- ggplot(d, aes(x=size, y=cache_misses, colour=container)) + geom_line() + ggtitle("cache misses")
+		q5 <- ggplot(d, aes(x=size, y=branch_misses, colour=container)) + geom_line() + ggtitle("branch misses")
+		png(paste(t, "_latency.png", sep=""), width = 1200, height = 600);
+		grid.arrange(q1, q2, q3, q4, q5, ncol = 3);
+	}
 }
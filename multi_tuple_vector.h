@@ -0,0 +1,202 @@
+/**
+ * \file	multi_tuple_vector.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __multi_tuple_vector_h
+#define __multi_tuple_vector_h
+
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include "tuple_vector.h"
+
+/**
+ * \brief tuple_vector for timeseries with non-decreasing keys, i.e. with several elements per
+ *		key like the ticks of a feed with millisecond timestamps - the counterpart of a
+ *		std::multimap.
+ *		The interpolation search works just the same, but it may land anywhere in a run of
+ *		equal keys. Every lookup that finds the key therefore steps back to the first element
+ *		of the run (see interpolation_search::_run_front()), which costs one more compare for a
+ *		run of one element and O(log m) for a run of m elements. find() and lower_bound()
+ *		return the first element of the run, upper_bound() the element after its last one and
+ *		equal_range() and count() the whole run.
+ *		merge() is not available, it relies on unique keys.
+ * \tparam K A datetime type, e.g. time_t, boost::posix_time::ptime or similar.
+ * \tparam V A value type, can be whatever is appropriate for the use-case.
+ * \tparam Stats lookup statistics policy, no_search_stats (default) or search_stats
+ * \tparam Allocator allocator of the elements, see tuple_vector
+ */
+template<typename K, typename V, typename Stats = no_search_stats, typename Allocator = std::allocator<std::pair<K,V>>>
+class multi_tuple_vector : public tuple_vector<K, V, Stats, Allocator> {
+	typedef tuple_vector<K, V, Stats, Allocator> base_type;
+	typedef interpolation_search<K, std::pair<K,V>, Stats> search_type;
+	using base_type::m_ctx;
+public:
+	typedef typename base_type::value_type						value_type;
+	typedef typename base_type::iterator						iterator;
+	typedef typename base_type::const_iterator					const_iterator;
+	typedef typename base_type::size_type						size_type;
+	typedef typename base_type::context_type					context_type;
+
+	using base_type::base_type;
+	multi_tuple_vector() { }
+
+	// Modifying operations.
+	using base_type::erase;
+	/// erase all elements with the given key
+	inline size_type erase(const K &key) {
+		auto range = equal_range(key);
+		const size_type n = range.second - range.first;
+		if (n)
+			base_type::erase(range.first, range.second);
+		return n;
+	}
+	template<typename BidirIt> void merge(BidirIt first, BidirIt last) = delete;
+
+	// Access operations
+	inline iterator at(const K &key) {
+		auto pos = find(key);
+		if (pos == base_type::end())
+			throw std::out_of_range("iterator multi_tuple_vector::at(const K &key)");
+		return pos;
+	}
+	inline const_iterator at(const K &key) const {
+		return at(key, m_ctx);
+	}
+	inline const_iterator at(const K &key, context_type &ctx) const {
+		auto pos = find(key, ctx);
+		if (pos == base_type::end())
+			throw std::out_of_range("const_iterator multi_tuple_vector::at(const K &key) const");
+		return pos;
+	}
+	using base_type::operator[];
+	inline const value_type &operator[](const K &key) const {
+		return *lower_bound(key);
+	}
+	inline value_type &operator[](const K &key) {
+		return *lower_bound(key);
+	}
+	/// first element not less than key
+	inline iterator lower_bound(const K &key) {
+		return _mutable(lower_bound(key, m_ctx));
+	}
+	inline const_iterator lower_bound(const K &key) const {
+		return lower_bound(key, m_ctx);
+	}
+	/// lower_bound() using the given search context, safe to call from several threads at once
+	inline const_iterator lower_bound(const K &key, context_type &ctx) const {
+		return const_iterator(_front_of(search_type::_lower_bound(key, ctx), key));
+	}
+	/// first element with the given key
+	inline iterator find(const K &key) {
+		return _mutable(find(key, m_ctx));
+	}
+	inline const_iterator find(const K &key) const {
+		return find(key, m_ctx);
+	}
+	/// find() using the given search context, safe to call from several threads at once
+	inline const_iterator find(const K &key, context_type &ctx) const {
+		const value_type *p = search_type::_find(key, ctx);
+		return const_iterator(p == search_type::_end() ? p : search_type::_run_front(p));
+	}
+	/**
+	 * \brief find() for a whole range of sorted or unsorted keys
+	 * \param out receives the index of the first element with every key, size() if the key
+	 *		was not found
+	 */
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt find_many(InputIt first, InputIt last, OutputIt out) const {
+		return find_many(first, last, out, m_ctx);
+	}
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt find_many(InputIt first, InputIt last, OutputIt out, context_type &ctx) const {
+		return search_type::_search_many(first, last, _run_front_out<OutputIt>{this, out}, true, ctx).out;
+	}
+	/**
+	 * \brief lower_bound() for a whole range of sorted or unsorted keys
+	 * \param out receives the index of every lower bound, size() if there is none
+	 */
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt lower_bound_many(InputIt first, InputIt last, OutputIt out) const {
+		return lower_bound_many(first, last, out, m_ctx);
+	}
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt lower_bound_many(InputIt first, InputIt last, OutputIt out, context_type &ctx) const {
+		return search_type::_search_many(first, last, _run_front_out<OutputIt>{this, out}, false, ctx).out;
+	}
+	/// first element greater than key
+	inline iterator upper_bound(const K &key) {
+		return _mutable(upper_bound(key, m_ctx));
+	}
+	inline const_iterator upper_bound(const K &key) const {
+		return upper_bound(key, m_ctx);
+	}
+	/// upper_bound() using the given search context, safe to call from several threads at once
+	inline const_iterator upper_bound(const K &key, context_type &ctx) const {
+		return equal_range(key, ctx).second;
+	}
+	/// all elements with the given key
+	inline std::pair<iterator, iterator> equal_range(const K &key) {
+		auto range = equal_range(key, m_ctx);
+		return std::make_pair(_mutable(range.first), _mutable(range.second));
+	}
+	inline std::pair<const_iterator, const_iterator> equal_range(const K &key) const {
+		return equal_range(key, m_ctx);
+	}
+	/// equal_range() using the given search context, safe to call from several threads at once
+	inline std::pair<const_iterator, const_iterator> equal_range(const K &key, context_type &ctx) const {
+		const value_type *p = search_type::_lower_bound(key, ctx);
+		if (p == search_type::_end() || p->first != key)
+			return std::make_pair(const_iterator(p), const_iterator(p));
+		return std::make_pair(const_iterator(search_type::_run_front(p)), const_iterator(search_type::_run_end(p)));
+	}
+	/// number of elements with the given key
+	inline size_type count(const K &key) const {
+		return count(key, m_ctx);
+	}
+	/// count() using the given search context, safe to call from several threads at once
+	inline size_type count(const K &key, context_type &ctx) const {
+		auto range = equal_range(key, ctx);
+		return range.second - range.first;
+	}
+
+	/// count, sum, min and max of all values with keys in [t0, t1), see tuple_vector::aggregate()
+	inline window_aggregate<V> aggregate(const K &t0, const K &t1) const {
+		return aggregate(t0, t1, m_ctx);
+	}
+	/// aggregate() using the given search context, safe to call from several threads at once
+	inline window_aggregate<V> aggregate(const K &t0, const K &t1, context_type &ctx) const {
+		const value_type *first = _front_of(search_type::_lower_bound(t0, ctx), t0);
+		const value_type *last = t0 < t1 ? _front_of(search_type::_lower_bound_after(first, t1, ctx), t1) : first;
+		return base_type::_aggregate(first, last);
+	}
+
+protected:
+	/// output iterator adaptor of find_many() and lower_bound_many(), moves every index to the front of its run
+	template<typename OutputIt>
+	struct _run_front_out {
+		const multi_tuple_vector *c;
+		OutputIt out;
+		inline _run_front_out &operator*() { return *this; }
+		inline _run_front_out &operator++() { ++out; return *this; }
+		inline _run_front_out operator++(int) { _run_front_out it(*this); ++out; return it; }
+		inline _run_front_out &operator=(size_t idx) {
+			const value_type *front = c->data();
+			*out = idx == c->size() ? idx : c->_run_front(front + idx) - front;
+			return *this;
+		}
+	};
+
+	/// the front of the run p is in, if p is a lower bound that landed on key
+	inline const value_type *_front_of(const value_type *p, const K &key) const {
+		return p != search_type::_end() && p->first == key ? search_type::_run_front(p) : p;
+	}
+	inline iterator _mutable(const_iterator it) {
+		return base_type::begin() + (it - base_type::cbegin());
+	}
+};
+
+#endif /* __multi_tuple_vector_h */
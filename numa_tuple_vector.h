@@ -0,0 +1,214 @@
+/**
+ * \file	numa_tuple_vector.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __numa_tuple_vector_h
+#define __numa_tuple_vector_h
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "tuple_vector.h"
+#include "allocators.h"
+
+/**
+ * \brief parse a Linux cpu or node list like "0-3,8,10-11" from sysfs
+ * \return the listed numbers, empty if the file does not exist
+ */
+inline std::vector<int> numa_read_list(const std::string &path)
+{
+	std::vector<int> list;
+	std::ifstream in(path);
+	std::string range;
+	while (std::getline(in, range, ',')) {
+		std::istringstream is(range);
+		int lo, hi;
+		char dash;
+		if (!(is >> lo))
+			continue;
+		if (!(is >> dash >> hi))
+			hi = lo;
+		for (int i = lo; i <= hi; i++)
+			list.push_back(i);
+	}
+	return list;
+}
+
+/// the online NUMA nodes, {0} if the machine has none or the kernel does not tell
+inline std::vector<int> numa_nodes()
+{
+	std::vector<int> nodes = numa_read_list("/sys/devices/system/node/online");
+	if (nodes.empty())
+		nodes.push_back(0);
+	return nodes;
+}
+
+/// the cpus of a NUMA node, empty if unknown
+inline std::vector<int> numa_node_cpus(int node)
+{
+	return numa_read_list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+}
+
+/// the cpu the calling thread runs on, 0 if unknown
+inline int numa_current_cpu()
+{
+#ifdef __linux__
+	int cpu = sched_getcpu();
+	return cpu < 0 ? 0 : cpu;
+#else
+	return 0;
+#endif
+}
+
+/**
+ * \brief pin the calling thread to the cpus of a NUMA node
+ * \return false if the node has no known cpus or the affinity could not be set
+ */
+inline bool numa_pin_thread(int node)
+{
+#ifdef __linux__
+	const std::vector<int> cpus = numa_node_cpus(node);
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (int cpu : cpus)
+		if (cpu < CPU_SETSIZE)
+			CPU_SET(cpu, &set);
+	return !cpus.empty() && sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+	(void)node;
+	return false;
+#endif
+}
+
+/**
+ * \brief tuple_vector replicated once per NUMA node for large series shared by reader threads
+ *		on several sockets. Every interpolation probe and resync scan of a lookup in a series
+ *		in the memory of another socket crosses the interconnect, with a replica per node each
+ *		thread searches memory of its own socket. The replicas use numa_allocator, so their
+ *		pages are bound to their node no matter which thread touches them first.
+ *		Lookups go to the replica of the node the calling thread currently runs on, found with
+ *		sched_getcpu() (which is answered without a system call) and a cpu to node table built
+ *		by the constructor. Reader threads should be pinned to a node (see numa_pin_thread()),
+ *		otherwise the scheduler may move them away from their replica at any time, and an
+ *		iterator returned by find() may then belong to a different replica than end(). A thread
+ *		which is not pinned should take local() once and search that replica instead.
+ *		Appends fan out to all replicas, so they cost one append per node, and either reach
+ *		every replica or, if one of them throws, none of them. Like tuple_vector, lookups with
+ *		their own search context can run concurrently, but not while appending.
+ *		On a machine with a single node, or with replicate set to false, there is only one
+ *		replica and a numa_tuple_vector behaves like a tuple_vector.
+ * \tparam K A datetime type, e.g. time_t, boost::posix_time::ptime or similar.
+ * \tparam V A value type, can be whatever is appropriate for the use-case.
+ * \tparam Stats lookup statistics policy of the replicas, no_search_stats (default) or search_stats
+ */
+template<typename K, typename V, typename Stats = no_search_stats>
+class numa_tuple_vector {
+public:
+	typedef std::pair<K,V>										value_type;
+	typedef tuple_vector<K, V, Stats, numa_allocator<value_type>>	replica_type;
+	typedef typename replica_type::const_iterator				const_iterator;
+	typedef size_t												size_type;
+	typedef typename replica_type::context_type					context_type;
+
+	/// \param replicate false for a single replica, e.g. to compare against
+	explicit numa_tuple_vector(bool replicate = true) {
+		const std::vector<int> nodes = replicate ? numa_nodes() : std::vector<int>(1, -1);
+		for (size_t r = 0; r < nodes.size(); r++) {
+			m_replicas.emplace_back(new replica_type(numa_allocator<value_type>(nodes[r])));
+			m_nodes.push_back(nodes[r]);
+			if (nodes[r] < 0)
+				continue;
+			for (int cpu : numa_node_cpus(nodes[r])) {
+				if ((size_t)cpu >= m_cpu_replica.size())
+					m_cpu_replica.resize(cpu + 1, 0);
+				m_cpu_replica[cpu] = r;
+			}
+		}
+	}
+
+	// Capacity
+	inline size_type size() const noexcept { return m_replicas[0]->size(); }
+	inline bool empty() const noexcept { return size() == 0; }
+	inline void reserve(size_type n) {
+		for (auto &r : m_replicas)
+			r->reserve(n);
+	}
+
+	// Modifying operations, applied to every replica.
+	void clear() noexcept {
+		for (auto &r : m_replicas)
+			r->clear();
+	}
+	template <typename... Args> inline void emplace_back(const K &key, Args&&... args) {
+		emplace_back(value_type(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...)));
+	}
+	/// append val to every replica, if one of them throws the others are rolled back before rethrowing
+	inline void emplace_back(const value_type &val) {
+		size_t r = 0;
+		try {
+			for (; r < m_replicas.size(); r++)
+				m_replicas[r]->emplace_back(val);
+		} catch (...) {
+			while (r--)
+				m_replicas[r]->pop_back();
+			throw;
+		}
+	}
+	inline void push_back(const value_type &val) {
+		emplace_back(val);
+	}
+	inline void pop_back() {
+		for (auto &r : m_replicas)
+			r->pop_back();
+	}
+
+	// Replicas
+	/// number of replicas, one per NUMA node
+	inline size_type replicas() const noexcept { return m_replicas.size(); }
+	/// NUMA node of replica r, -1 if it is not bound to one
+	inline int node(size_t r) const { return m_nodes.at(r); }
+	/// replica r
+	inline const replica_type &replica(size_t r) const { return *m_replicas.at(r); }
+	/// index of the replica of the node the calling thread runs on
+	inline size_t local_index() const {
+		const size_t cpu = numa_current_cpu();
+		return cpu < m_cpu_replica.size() ? m_cpu_replica[cpu] : 0;
+	}
+	/// the replica of the node the calling thread runs on
+	inline const replica_type &local() const { return *m_replicas[local_index()]; }
+
+	// Access operations on the local replica, the iterators point into it.
+	inline const_iterator begin() const { return local().begin(); }
+	inline const_iterator end() const { return local().end(); }
+	inline const value_type &operator[](size_t idx) const { return local()[idx]; }
+	inline const value_type &back() const { return local().back(); }
+	/// find() in the local replica using the given search context, safe to call from several threads at once
+	inline const_iterator find(const K &key, context_type &ctx) const { return local().find(key, ctx); }
+	/// lower_bound() in the local replica using the given search context, safe to call from several threads at once
+	inline const_iterator lower_bound(const K &key, context_type &ctx) const { return local().lower_bound(key, ctx); }
+	/// upper_bound() in the local replica using the given search context, safe to call from several threads at once
+	inline const_iterator upper_bound(const K &key, context_type &ctx) const { return local().upper_bound(key, ctx); }
+	/// at() in the local replica using the given search context, safe to call from several threads at once
+	inline const_iterator at(const K &key, context_type &ctx) const { return local().at(key, ctx); }
+
+private:
+	/// one tuple_vector per node
+	std::vector<std::unique_ptr<replica_type>> m_replicas;
+	/// node of every replica
+	std::vector<int> m_nodes;
+	/// replica index for every cpu
+	std::vector<size_t> m_cpu_replica;
+};
+
+#endif /* __numa_tuple_vector_h */
@@ -3,11 +3,29 @@
 #include <array>
 #include <vector>
 #include <map>
+#include <mutex>
+#include <random>
+#include <thread>
 
 // please also clone my cppbench library ( https://github.com/sinisa-susnjar/cppbench.git )
 #include "../cppbench/cppbench.h"
 
 #include "tuple_vector.h"
+#include "columnar_tuple_vector.h"
+#include "compressed_tuple_vector.h"
+#include "mapped_tuple_vector.h"
+#include "resample.h"
+#include "bulk_load.h"
+#include "allocators.h"
+#include "tuple_panel.h"
+#include "chunked_tuple_vector.h"
+#include "loader.h"
+#include "delta_tuple_vector.h"
+#include "snapshot_tuple_vector.h"
+#include "cursor.h"
+#include "multi_tuple_vector.h"
+#include "numa_tuple_vector.h"
+#include "tuple_view.h"
 #include "common.h"
 
 using namespace std;
@@ -36,33 +54,84 @@ void Rdata(ostream &os, const cppbench::runtime_result &result, const string &na
 			<< endl;
 }
 
+/// key distributions used to generate the test timeseries
+enum distribution {
+	uniform,	///< strictly increasing keys without any gaps
+	sparse,		///< every 23rd key is followed by a gap of one
+	outliers,	///< uniform keys with a few huge gaps which skew the interpolation
+	bursts		///< dense runs of 1000 keys separated by long gaps, like trading sessions
+};
+
+/// advance dt by n steps
+template<typename K>
+void skip(K &dt, size_t n) {
+	while (n--)
+		dt++;
+}
+
+template<>
+void skip(time_t &dt, size_t n) {
+	dt += n;
+}
+
+/**
+ * \brief create dummy timeseries with strictly increasing time values
+ * \param sz number of elements
+ * \param dist how the keys are distributed
+ * \tparam K a datetime type supporting initialisation from int and post-increment
+ */
+template<typename K>
+vector<pair<K, double>> make_timeseries(size_t sz, distribution dist)
+{
+	vector<pair<K, double>> ts;
+	K dt = 0;
+
+	for (size_t n = 0; n < sz; n++, dt++) {
+		ts.emplace_back(dt, 3.1415926);
+		switch (dist) {
+		case sparse:
+			if (n%23 == 0) dt++;
+			break;
+		case outliers:
+			if (n == 0 || n == sz/2 || n == sz-2) skip(dt, sz*1000);
+			break;
+		case bursts:
+			if (n%1000 == 999) skip(dt, 50000);
+			break;
+		default:
+			break;
+		}
+	}
+	return ts;
+}
+
 /**
  * \brief run_tests template function for running same tests for different types of datetime types
  * \param n_tests number of runs for each test
  * \param start_sz container start size
  * \param end_sz container max size
  * \param sz_step container size increment
+ * \param dist how the keys of the test timeseries are distributed
  * \tparam K a datetime type supporting initialisation from int and post-increment
  */
 template<typename K>
-void run_tests(ofstream &&ofs, size_t n_tests, size_t start_sz, size_t end_sz, size_t sz_step)
+void run_tests(ofstream &&ofs, size_t n_tests, size_t start_sz, size_t end_sz, size_t sz_step, distribution dist = uniform)
 {
 	ofs << "test" << '\t' << "size" << '\t' << "container" << '\t'
 		<< "runtime" << '\t' << "min" << '\t' << "max" << '\t'
 		<< "avg" << '\t' << "var" << '\t' << "dev" << endl;
 	for (size_t sz = start_sz; sz <= end_sz; sz += sz_step) {
-		vector<pair<K, double>> ts;
-		K dt = 0;
-
-		// create dummy timeseries with strictly increasing time values
-		for (size_t n = 0; n < sz; n++, dt++) {
-			ts.emplace_back(dt, 3.1415926);
-			// if (n%23 == 0) dt++; // uncomment to add some "sparsity" - this should decrease the access performance (a little)
-		}
+		vector<pair<K, double>> ts = make_timeseries<K>(sz, dist);
 
 		vector<pair<K, double>> vec;
 		tuple_vector<K, double> tv;
+		columnar_tuple_vector<K, double> ctv;
 		map<K, double> map;
+		// the keys of ts in random order, looked up by most of the tests
+		vector<K> shuffled;
+		for (const auto &i : ts)
+			shuffled.push_back(i.first);
+		shuffle(shuffled.begin(), shuffled.end(), mt19937(shuffled.size()));
 
 		{	// emplace performance
 			cout << "emplace with size " << sz << endl;
@@ -89,6 +158,116 @@ void run_tests(ofstream &&ofs, size_t n_tests, size_t start_sz, size_t end_sz, s
 			#include "tests/lower_bound_test.h"
 			Rdata(ofs, rt, "lower_bound", sz);
 		}
+		{	// learned index performance
+			cout << "learned_index with size " << sz << endl;
+			#include "tests/learned_index_test.h"
+			Rdata(ofs, rt, "learned_index", sz);
+		}
+		{	// append-while-querying performance
+			cout << "append_query with size " << sz << endl;
+			#include "tests/append_query_test.h"
+			Rdata(ofs, rt, "append_query", sz);
+		}
+		{	// concurrent find() performance
+			cout << "concurrent find with size " << sz << endl;
+			#include "tests/concurrent_find_test.h"
+			Rdata(ofs, rt, "concurrent_find", sz);
+		}
+		{	// lookup statistics overhead
+			cout << "stats with size " << sz << endl;
+			#include "tests/stats_test.h"
+			Rdata(ofs, rt, "stats", sz);
+		}
+		{	// parallel bulk load performance
+			cout << "bulk_load with size " << sz << endl;
+			#include "tests/bulk_load_test.h"
+			Rdata(ofs, rt, "bulk_load", sz);
+		}
+		{	// huge page performance
+			cout << "huge_pages with size " << sz << endl;
+			#include "tests/huge_pages_test.h"
+			Rdata(ofs, rt, "huge_pages", sz);
+		}
+		{	// multi-column panel performance
+			cout << "panel with size " << sz << endl;
+			#include "tests/panel_test.h"
+			Rdata(ofs, rt, "panel", sz);
+		}
+		{	// chunked storage performance
+			cout << "chunked with size " << sz << endl;
+			#include "tests/chunked_test.h"
+			Rdata(ofs, rt, "chunked", sz);
+		}
+		{	// loader performance
+			cout << "loader with size " << sz << endl;
+			#include "tests/loader_test.h"
+			Rdata(ofs, rt, "loader", sz);
+		}
+		{	// late insert performance
+			cout << "delta with size " << sz << endl;
+			#include "tests/delta_test.h"
+			Rdata(ofs, rt, "delta", sz);
+		}
+		{	// snapshot publishing performance
+			cout << "snapshot with size " << sz << endl;
+			#include "tests/snapshot_test.h"
+			Rdata(ofs, rt, "snapshot", sz);
+		}
+		{	// cursor replay performance
+			cout << "cursor with size " << sz << endl;
+			#include "tests/cursor_test.h"
+			Rdata(ofs, rt, "cursor", sz);
+		}
+		{	// duplicate key performance
+			cout << "multi with size " << sz << endl;
+			#include "tests/multi_test.h"
+			Rdata(ofs, rt, "multi", sz);
+		}
+		{	// NUMA replica performance
+			cout << "numa with size " << sz << endl;
+			#include "tests/numa_test.h"
+			Rdata(ofs, rt, "numa", sz);
+		}
+		{	// adoption of existing buffers performance
+			cout << "adopt with size " << sz << endl;
+			#include "tests/adopt_test.h"
+			Rdata(ofs, rt, "adopt", sz);
+		}
+		{	// time window aggregate performance
+			cout << "window with size " << sz << endl;
+			#include "tests/window_test.h"
+			Rdata(ofs, rt, "window", sz);
+		}
+		{	// as-of join performance
+			cout << "asof_join with size " << sz << endl;
+			#include "tests/asof_join_test.h"
+			Rdata(ofs, rt, "asof_join", sz);
+		}
+		{	// resampling performance
+			cout << "resample with size " << sz << endl;
+			#include "tests/resample_test.h"
+			Rdata(ofs, rt, "resample", sz);
+		}
+		{	// nanosecond std::chrono key performance
+			cout << "nanosecond with size " << sz << endl;
+			#include "tests/nanosecond_test.h"
+			Rdata(ofs, rt, "nanosecond", sz);
+		}
+		{	// compressed key performance
+			cout << "compressed with size " << sz << endl;
+			#include "tests/compressed_test.h"
+			Rdata(ofs, rt, "compressed", sz);
+		}
+		{	// memory-mapped find() performance
+			cout << "mapped with size " << sz << endl;
+			#include "tests/mapped_test.h"
+			Rdata(ofs, rt, "mapped", sz);
+		}
+		{	// resync scan performance on sparse data
+			cout << "scan with size " << sz << endl;
+			#include "tests/scan_test.h"
+			Rdata(ofs, rt, "scan", sz);
+		}
 	}
 }
 
@@ -101,4 +280,15 @@ int main()
 
 	cout << endl << "RUNNING TESTS FOR boost::posix_time::ptime" << endl;
 	run_tests<my_ptime>(ofstream("ptime.txt"), 100, 10000, 1000000, 10000);
+
+	// adversarial key distributions - the galloping search in tuple_vector bounds these to O(log n)
+
+	cout << endl << "RUNNING TESTS FOR time_t WITH SPARSE KEYS" << endl;
+	run_tests<time_t>(ofstream("timet_sparse.txt"), 100, 10000, 1000000, 10000, sparse);
+
+	cout << endl << "RUNNING TESTS FOR time_t WITH OUTLIERS" << endl;
+	run_tests<time_t>(ofstream("timet_outliers.txt"), 100, 10000, 1000000, 10000, outliers);
+
+	cout << endl << "RUNNING TESTS FOR time_t WITH BURSTS" << endl;
+	run_tests<time_t>(ofstream("timet_bursts.txt"), 100, 10000, 1000000, 10000, bursts);
 }
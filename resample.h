@@ -0,0 +1,106 @@
+/**
+ * \file	resample.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __resample_h
+#define __resample_h
+
+#include <cmath>
+#include <cstdint>
+
+#include "asof_join.h"
+
+/**
+ * \brief open, high, low and close value plus the number of elements of one time bucket
+ * \tparam V value type
+ */
+template<typename V>
+struct ohlc {
+	V open, high, low, close;
+	size_t count;
+};
+
+/**
+ * \brief bucket functor for resample_ohlc() and resample_last() that splits the keys into
+ *		fixed-width buckets numbered from origin, i.e. bucket n holds all keys in
+ *		[origin + n * width, origin + (n + 1) * width), in key<K> units
+ * \tparam K key type
+ */
+template<typename K>
+struct fixed_buckets {
+	fixed_buckets(double width, double origin = 0) : m_width(width), m_origin(origin) { }
+	inline int64_t operator()(const K &k) const { return (int64_t)std::floor((::key<K>()(k) - m_origin) / m_width); }
+private:
+	double m_width, m_origin;
+};
+
+/**
+ * \brief end of the bucket starting at first, i.e. the first element for which pred is false
+ *		Most buckets hold about as many elements as the previous one, so that guess is verified
+ *		first before falling back to galloping with asof_advance().
+ * \param size number of elements in the previous bucket
+ */
+template<typename It, typename Pred>
+inline It resample_bucket_end(It first, It last, Pred pred, typename std::iterator_traits<It>::difference_type size)
+{
+	if (size > 1 && last - first >= size && pred(first[size - 1]) && (last - first == size || !pred(first[size])))
+		return first + size;
+	return asof_advance(first, last, pred);
+}
+
+/**
+ * \brief resample a timeseries into one OHLC bar per time bucket in a single pass
+ *		Every run of consecutive elements with the same bucket label becomes one element of out,
+ *		empty buckets produce nothing. The end of each bucket is found before its values are
+ *		read, see resample_bucket_end(), so the bucket functor is only called twice for a bucket
+ *		as big as the one before and O(log m) times for any other bucket of m elements.
+ * \param src timeseries to resample, e.g. a tuple_vector or columnar_tuple_vector
+ * \param bucket functor mapping a key to its bucket label, e.g. fixed_buckets<K>(60) or
+ *		[](time_t t) { return t - t % 60; }, labels must not decrease with the keys
+ * \param out receives out.emplace_back(label, ohlc<V>{...}) for every bucket, e.g. a
+ *		tuple_vector<B, ohlc<V>> or std::vector<std::pair<B, ohlc<V>>>
+ */
+template<typename C, typename Bucket, typename Out>
+void resample_ohlc(const C &src, Bucket bucket, Out &out)
+{
+	typedef typename std::decay<decltype(src.begin()->second)>::type V;
+	auto it = src.begin(), end = src.end();
+	typename std::iterator_traits<decltype(it)>::difference_type size = 0;
+	while (it != end) {
+		auto label = bucket(it->first);
+		// find the end of the bucket first, so the loop below only has to look at the values
+		auto last = resample_bucket_end(it, end, [&bucket,&label](const decltype(*it) &e) { return bucket(e.first) == label; }, size);
+		size = last - it;
+		ohlc<V> bar{it->second, it->second, it->second, (last - 1)->second, (size_t)(last - it)};
+		for (++it; it != last; ++it) {
+			const V &v = it->second;
+			bar.high = bar.high < v ? v : bar.high;
+			bar.low = v < bar.low ? v : bar.low;
+		}
+		out.emplace_back(label, bar);
+	}
+}
+
+/**
+ * \brief resample a timeseries into the last value of every time bucket, see resample_ohlc()
+ *		Each bucket is skipped with resample_bucket_end() instead of walking over it.
+ * \param out receives out.emplace_back(label, value) for every bucket
+ */
+template<typename C, typename Bucket, typename Out>
+void resample_last(const C &src, Bucket bucket, Out &out)
+{
+	auto it = src.begin(), end = src.end();
+	typename std::iterator_traits<decltype(it)>::difference_type size = 0;
+	while (it != end) {
+		auto label = bucket(it->first);
+		// only the last value is needed, so skip to the end of the bucket instead of walking
+		auto last = resample_bucket_end(it, end, [&bucket,&label](const decltype(*it) &e) { return bucket(e.first) == label; }, size);
+		size = last - it;
+		it = last;
+		out.emplace_back(label, (it - 1)->second);
+	}
+}
+
+#endif /* __resample_h */
@@ -3,11 +3,29 @@
 #include <array>
 #include <vector>
 #include <map>
+#include <mutex>
+#include <random>
+#include <thread>
 
 // please also clone my cppbench library ( https://github.com/sinisa-susnjar/cppbench.git )
 #include "../cppbench/cppbench.h"
 
 #include "tuple_vector.h"
+#include "columnar_tuple_vector.h"
+#include "compressed_tuple_vector.h"
+#include "mapped_tuple_vector.h"
+#include "resample.h"
+#include "bulk_load.h"
+#include "allocators.h"
+#include "tuple_panel.h"
+#include "chunked_tuple_vector.h"
+#include "loader.h"
+#include "delta_tuple_vector.h"
+#include "snapshot_tuple_vector.h"
+#include "cursor.h"
+#include "multi_tuple_vector.h"
+#include "numa_tuple_vector.h"
+#include "tuple_view.h"
 #include "common.h"
 
 using namespace std;
@@ -33,8 +51,14 @@ void run_tests()
 	}
 
 	tuple_vector<K, double> tv;
+	columnar_tuple_vector<K, double> ctv;
 	map<K, double> map;
 	vector<pair<K, double>> vec;
+	// the keys of ts in random order, looked up by most of the tests
+	vector<K> shuffled;
+	for (const auto &i : ts)
+		shuffled.push_back(i.first);
+	shuffle(shuffled.begin(), shuffled.end(), mt19937(shuffled.size()));
 
 	{	// emplace performance
 		#include "tests/emplace_test.h"
@@ -61,6 +85,116 @@ void run_tests()
 		cout << endl << "lower_bound()" << endl;
 		cppbench::print( cppbench::compare(rt) );
 	}
+	{	// learned index performance
+		#include "tests/learned_index_test.h"
+		cout << endl << "learned index (random find() + lower_bound())" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// append-while-querying performance
+		#include "tests/append_query_test.h"
+		cout << endl << "append while querying" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// concurrent find() performance
+		#include "tests/concurrent_find_test.h"
+		cout << endl << "concurrent find()" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// lookup statistics overhead
+		#include "tests/stats_test.h"
+		cout << endl << "lookup statistics (random find())" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// parallel bulk load performance
+		#include "tests/bulk_load_test.h"
+		cout << endl << "bulk load (4 unsorted feeds)" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// huge page performance
+		#include "tests/huge_pages_test.h"
+		cout << endl << "random find() on 4K pages vs. huge pages" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// multi-column panel performance
+		#include "tests/panel_test.h"
+		cout << endl << "bid, ask and size: 3 tuple_vectors vs. tuple_panel (random find())" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// chunked storage performance
+		#include "tests/chunked_test.h"
+		cout << endl << "vector-backed vs. chunked storage (emplace_back(), random find())" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// loader performance
+		#include "tests/loader_test.h"
+		cout << endl << "loading text and binary files" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// late insert performance
+		#include "tests/delta_test.h"
+		cout << endl << "late inserts into tuple_vector vs. delta_tuple_vector" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// snapshot publishing performance
+		#include "tests/snapshot_test.h"
+		cout << endl << "3 readers and 1 appending writer, mutex vs. snapshots" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// cursor replay performance
+		#include "tests/cursor_test.h"
+		cout << endl << "replay of increasing keys, lower_bound() vs. tuple_cursor" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// duplicate key performance
+		#include "tests/multi_test.h"
+		cout << endl << "1 - 3 elements per key, std::multimap vs. multi_tuple_vector" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// NUMA replica performance
+		#include "tests/numa_test.h"
+		cout << endl << "find() from one pinned thread per NUMA node, tuple_vector vs. numa_tuple_vector" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// adoption of existing buffers performance
+		#include "tests/adopt_test.h"
+		cout << endl << "vector of pairs to tuple_vector: emplace_back, copy, adopt and view" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// time window aggregate performance
+		#include "tests/window_test.h"
+		cout << endl << "window aggregates (100 windows of 10 - 1M elements)" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// as-of join performance
+		#include "tests/asof_join_test.h"
+		cout << endl << "as-of join (backward)" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// resampling performance
+		#include "tests/resample_test.h"
+		cout << endl << "resample (buckets of 60 elements)" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// nanosecond std::chrono key performance
+		#include "tests/nanosecond_test.h"
+		cout << endl << "nanosecond std::chrono keys (random find())" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// compressed key performance
+		#include "tests/compressed_test.h"
+		cout << endl << "compressed keys (find())" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// memory-mapped find() performance
+		#include "tests/mapped_test.h"
+		cout << endl << "memory-mapped (random find())" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
+	{	// resync scan performance on sparse data
+		#include "tests/scan_test.h"
+		cout << endl << "scan (sparse find() + lower_bound())" << endl;
+		cppbench::print( cppbench::compare(rt) );
+	}
 }
 
 int main()
@@ -0,0 +1,252 @@
+/**
+ * \file	simd_scan.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __simd_scan_h
+#define __simd_scan_h
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(TUPLE_VECTOR_NO_SIMD)
+#define TUPLE_VECTOR_SIMD 1
+#include <immintrin.h>
+#endif
+
+/**
+ * The resync scans in interpolation_search walk forward or backward from the initial guess
+ * one element at a time. For integral keys of 4 or 8 bytes the functions in this file compare
+ * a whole block of keys at once (AVX2: 8x32 or 4x64 bit, SSE4.2: 4x32 or 2x2x64 bit). Since the
+ * keys are sorted, the number of keys in a block that are less (greater) than the sought key is
+ * exactly the number of elements the scalar loop would have stepped over, so a popcount of the
+ * comparison mask is all that is needed.
+ * The instruction set is selected once at runtime, everything else falls back to the scalar loop.
+ * Define TUPLE_VECTOR_NO_SIMD to always use the scalar loop.
+ * Keys are read at (const char *)p + i * stride, so the same kernels serve the std::pair<K,V>
+ * elements of tuple_vector (gathered) and the key column of columnar_tuple_vector (loaded).
+ */
+namespace simd_scan {
+
+enum level { scalar = 0, sse42 = 1, avx2 = 2 };
+
+/// instruction set used by the scan kernels, determined once on first use
+inline level cpu_level() {
+#ifdef TUPLE_VECTOR_SIMD
+	static const level l = __builtin_cpu_supports("avx2") ? avx2 : __builtin_cpu_supports("sse4.2") ? sse42 : scalar;
+	return l;
+#else
+	return scalar;
+#endif
+}
+
+/// true for key types the kernels can compare directly
+template<typename K>
+struct is_simd_key : std::integral_constant<bool,
+	std::is_integral<K>::value && !std::is_same<K, bool>::value && (sizeof(K) == 4 || sizeof(K) == 8)> { };
+
+#ifdef TUPLE_VECTOR_SIMD
+
+/// xor mask that maps unsigned keys onto signed ones so that signed compares give the right order
+template<typename K>
+constexpr int64_t sign_bias() {
+	return std::is_signed<K>::value ? 0 : (sizeof(K) == 8 ? INT64_MIN : INT32_MIN);
+}
+
+__attribute__((target("avx2"), always_inline))
+inline __m256i avx2_load64(const char *p, size_t stride, const __m256i &idx) {
+	return stride == 8 ? _mm256_loadu_si256((const __m256i *)p) : _mm256_i64gather_epi64((const long long *)p, idx, 1);
+}
+
+__attribute__((target("avx2"), always_inline))
+inline __m256i avx2_load32(const char *p, size_t stride, const __m256i &idx) {
+	return stride == 4 ? _mm256_loadu_si256((const __m256i *)p) : _mm256_i32gather_epi32((const int *)p, idx, 1);
+}
+
+/**
+ * \brief forward scan over n keys starting at p
+ * \return number of leading keys less than key, only whole blocks are scanned - the caller
+ *		finishes the remaining tail with the scalar loop
+ */
+template<typename K>
+__attribute__((target("avx2")))
+size_t avx2_forward(const char *p, size_t n, size_t stride, K key) {
+	size_t i = 0;
+	if (sizeof(K) == 8) {
+		const __m256i bias = _mm256_set1_epi64x(sign_bias<K>());
+		const __m256i needle = _mm256_xor_si256(_mm256_set1_epi64x((int64_t)key), bias);
+		const __m256i idx = _mm256_set_epi64x(3 * stride, 2 * stride, stride, 0);
+		for (; i + 4 <= n; i += 4, p += 4 * stride) {
+			__m256i k = _mm256_xor_si256(avx2_load64(p, stride, idx), bias);
+			int c = __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(needle, k))));
+			if (c < 4)
+				return i + c;
+		}
+	} else {
+		const __m256i bias = _mm256_set1_epi32((int32_t)sign_bias<K>());
+		const __m256i needle = _mm256_xor_si256(_mm256_set1_epi32((int32_t)key), bias);
+		const int s = (int)stride;
+		const __m256i idx = _mm256_set_epi32(7 * s, 6 * s, 5 * s, 4 * s, 3 * s, 2 * s, s, 0);
+		for (; i + 8 <= n; i += 8, p += 8 * stride) {
+			__m256i k = _mm256_xor_si256(avx2_load32(p, stride, idx), bias);
+			int c = __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(needle, k))));
+			if (c < 8)
+				return i + c;
+		}
+	}
+	return i;
+}
+
+/**
+ * \brief backward scan over n keys ending at p (inclusive), i.e. p, p - stride, ...
+ * \return number of trailing keys greater than key, only whole blocks are scanned
+ */
+template<typename K>
+__attribute__((target("avx2")))
+size_t avx2_backward(const char *p, size_t n, size_t stride, K key) {
+	size_t i = 0;
+	if (sizeof(K) == 8) {
+		const __m256i bias = _mm256_set1_epi64x(sign_bias<K>());
+		const __m256i needle = _mm256_xor_si256(_mm256_set1_epi64x((int64_t)key), bias);
+		const __m256i idx = _mm256_set_epi64x(3 * stride, 2 * stride, stride, 0);
+		for (p -= 3 * stride; i + 4 <= n; i += 4, p -= 4 * stride) {
+			__m256i k = _mm256_xor_si256(avx2_load64(p, stride, idx), bias);
+			int c = __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, needle))));
+			if (c < 4)
+				return i + c;
+		}
+	} else {
+		const __m256i bias = _mm256_set1_epi32((int32_t)sign_bias<K>());
+		const __m256i needle = _mm256_xor_si256(_mm256_set1_epi32((int32_t)key), bias);
+		const int s = (int)stride;
+		const __m256i idx = _mm256_set_epi32(7 * s, 6 * s, 5 * s, 4 * s, 3 * s, 2 * s, s, 0);
+		for (p -= 7 * stride; i + 8 <= n; i += 8, p -= 8 * stride) {
+			__m256i k = _mm256_xor_si256(avx2_load32(p, stride, idx), bias);
+			int c = __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(k, needle))));
+			if (c < 8)
+				return i + c;
+		}
+	}
+	return i;
+}
+
+__attribute__((target("sse4.2"), always_inline))
+inline __m128i sse42_load64(const char *p, size_t stride) {
+	return stride == 8 ? _mm_loadu_si128((const __m128i *)p) : _mm_set_epi64x(*(const int64_t *)(p + stride), *(const int64_t *)p);
+}
+
+__attribute__((target("sse4.2"), always_inline))
+inline __m128i sse42_load32(const char *p, size_t stride) {
+	return stride == 4 ? _mm_loadu_si128((const __m128i *)p) : _mm_set_epi32(*(const int32_t *)(p + 3 * stride),
+		*(const int32_t *)(p + 2 * stride), *(const int32_t *)(p + stride), *(const int32_t *)p);
+}
+
+/// SSE4.2 version of avx2_forward()
+template<typename K>
+__attribute__((target("sse4.2")))
+size_t sse42_forward(const char *p, size_t n, size_t stride, K key) {
+	size_t i = 0;
+	if (sizeof(K) == 8) {
+		const __m128i bias = _mm_set1_epi64x(sign_bias<K>());
+		const __m128i needle = _mm_xor_si128(_mm_set1_epi64x((int64_t)key), bias);
+		for (; i + 4 <= n; i += 4, p += 4 * stride) {
+			__m128i lo = _mm_cmpgt_epi64(needle, _mm_xor_si128(sse42_load64(p, stride), bias));
+			__m128i hi = _mm_cmpgt_epi64(needle, _mm_xor_si128(sse42_load64(p + 2 * stride, stride), bias));
+			int c = __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(lo)) | _mm_movemask_pd(_mm_castsi128_pd(hi)) << 2);
+			if (c < 4)
+				return i + c;
+		}
+	} else {
+		const __m128i bias = _mm_set1_epi32((int32_t)sign_bias<K>());
+		const __m128i needle = _mm_xor_si128(_mm_set1_epi32((int32_t)key), bias);
+		for (; i + 4 <= n; i += 4, p += 4 * stride) {
+			__m128i k = _mm_xor_si128(sse42_load32(p, stride), bias);
+			int c = __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(needle, k))));
+			if (c < 4)
+				return i + c;
+		}
+	}
+	return i;
+}
+
+/// SSE4.2 version of avx2_backward()
+template<typename K>
+__attribute__((target("sse4.2")))
+size_t sse42_backward(const char *p, size_t n, size_t stride, K key) {
+	size_t i = 0;
+	if (sizeof(K) == 8) {
+		const __m128i bias = _mm_set1_epi64x(sign_bias<K>());
+		const __m128i needle = _mm_xor_si128(_mm_set1_epi64x((int64_t)key), bias);
+		for (p -= 3 * stride; i + 4 <= n; i += 4, p -= 4 * stride) {
+			__m128i lo = _mm_cmpgt_epi64(_mm_xor_si128(sse42_load64(p, stride), bias), needle);
+			__m128i hi = _mm_cmpgt_epi64(_mm_xor_si128(sse42_load64(p + 2 * stride, stride), bias), needle);
+			int c = __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(lo)) | _mm_movemask_pd(_mm_castsi128_pd(hi)) << 2);
+			if (c < 4)
+				return i + c;
+		}
+	} else {
+		const __m128i bias = _mm_set1_epi32((int32_t)sign_bias<K>());
+		const __m128i needle = _mm_xor_si128(_mm_set1_epi32((int32_t)key), bias);
+		for (p -= 3 * stride; i + 4 <= n; i += 4, p -= 4 * stride) {
+			__m128i k = _mm_xor_si128(sse42_load32(p, stride), bias);
+			int c = __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(k, needle))));
+			if (c < 4)
+				return i + c;
+		}
+	}
+	return i;
+}
+
+#endif /* TUPLE_VECTOR_SIMD */
+
+/**
+ * \brief number of keys at the start of p[0..n) that are less than key, whole blocks only
+ * \param p address of the first key
+ * \param n number of keys that may be examined
+ * \param stride distance in bytes between two consecutive keys
+ */
+template<typename K>
+inline typename std::enable_if<is_simd_key<K>::value, size_t>::type forward(const K *p, size_t n, size_t stride, const K &key) {
+#ifdef TUPLE_VECTOR_SIMD
+	switch (cpu_level()) {
+	case avx2: return avx2_forward<K>((const char *)p, n, stride, key);
+	case sse42: return sse42_forward<K>((const char *)p, n, stride, key);
+	default: break;
+	}
+#endif
+	return 0;
+}
+
+template<typename K>
+inline typename std::enable_if<!is_simd_key<K>::value, size_t>::type forward(const K *, size_t, size_t, const K &) {
+	return 0;
+}
+
+/**
+ * \brief number of keys at the end of p[-n+1..0] that are greater than key, whole blocks only
+ * \param p address of the last key
+ * \param n number of keys that may be examined
+ * \param stride distance in bytes between two consecutive keys
+ */
+template<typename K>
+inline typename std::enable_if<is_simd_key<K>::value, size_t>::type backward(const K *p, size_t n, size_t stride, const K &key) {
+#ifdef TUPLE_VECTOR_SIMD
+	switch (cpu_level()) {
+	case avx2: return avx2_backward<K>((const char *)p, n, stride, key);
+	case sse42: return sse42_backward<K>((const char *)p, n, stride, key);
+	default: break;
+	}
+#endif
+	return 0;
+}
+
+template<typename K>
+inline typename std::enable_if<!is_simd_key<K>::value, size_t>::type backward(const K *, size_t, size_t, const K &) {
+	return 0;
+}
+
+} // namespace simd_scan
+
+#endif /* __simd_scan_h */
@@ -0,0 +1,271 @@
+/**
+ * \file	snapshot_tuple_vector.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __snapshot_tuple_vector_h
+#define __snapshot_tuple_vector_h
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "tuple_vector.h"
+
+/// maximum number of concurrent snapshot_tuple_vector::reader objects per container
+#ifndef TUPLE_VECTOR_MAX_READERS
+#define TUPLE_VECTOR_MAX_READERS 64
+#endif
+
+/**
+ * \brief Single writer, multiple reader variant of tuple_vector. One thread appends with
+ *		emplace_back() while any number of reader threads (up to TUPLE_VECTOR_MAX_READERS)
+ *		look up elements without taking a lock.
+ *		Elements are never modified once appended, so a reader only needs a consistent pair of
+ *		buffer and size: the writer constructs the new element and then publishes the new size
+ *		with a release store. When the buffer is full, the writer copies the elements into a
+ *		buffer twice the size and publishes the new buffer with an atomic store. The old one is
+ *		retired and only freed once no reader can still be using it (epoch-based reclamation):
+ *		every reader announces the epoch in which it took its snapshot in a slot of its own,
+ *		and a buffer retired in epoch r is freed by the writer once all active readers have
+ *		entered a later epoch.
+ *		Readers first register a reader, which claims a slot and keeps the search context of
+ *		the thread, and then take snapshots from it:
+ *
+ *			snapshot_tuple_vector<K, V>::reader r(stv);	// once per thread
+ *			auto snap = r.snapshot();					// cheap, no allocation
+ *			auto it = snap.find(key);
+ *
+ *		A snapshot sees all elements appended before it was taken and none after, and keeps
+ *		its buffer alive until it is destroyed, so long-lived snapshots delay the reclamation.
+ * \tparam K A datetime type, e.g. time_t, boost::posix_time::ptime or similar.
+ * \tparam V A value type, can be whatever is appropriate for the use-case.
+ * \tparam Stats lookup statistics policy of the reader search contexts, no_search_stats
+ *		(default) or search_stats
+ */
+template<typename K, typename V, typename Stats = no_search_stats>
+class snapshot_tuple_vector {
+	/// one buffer of elements, size is the number of published elements
+	struct buffer {
+		buffer(size_t cap) : size(0), capacity(cap), data(std::allocator<std::pair<K,V>>().allocate(cap)) { }
+		~buffer() {
+			const size_t n = size.load(std::memory_order_relaxed);
+			for (size_t i = 0; i < n; i++)
+				data[i].~pair();
+			std::allocator<std::pair<K,V>>().deallocate(data, capacity);
+		}
+		std::atomic<size_t> size;
+		size_t capacity;
+		std::pair<K,V> *data;
+	};
+
+	/// epoch announced by one reader, 0 while it holds no snapshot
+	struct alignas(64) slot {
+		std::atomic<uint64_t> epoch{0};
+		std::atomic<bool> used{false};
+	};
+
+public:
+	typedef std::pair<K,V>										value_type;
+	typedef const value_type									*const_iterator;
+	typedef size_t												size_type;
+	typedef basic_search_context<Stats>							context_type;
+
+	class reader;
+
+	/**
+	 * \brief immutable view of the elements published when it was taken, see reader::snapshot()
+	 *		The lookups return pointers into the buffer, which stay valid as long as the snapshot.
+	 */
+	class snapshot : public interpolation_search<K, value_type, Stats> {
+		typedef interpolation_search<K, value_type, Stats> search_type;
+		friend class reader;
+	public:
+		snapshot(const snapshot &) = delete;
+		snapshot &operator=(const snapshot &) = delete;
+		snapshot(snapshot &&x) : search_type(x), m_reader(x.m_reader), m_data(x.m_data), m_size(x.m_size) { x.m_reader = nullptr; }
+		~snapshot() {
+			if (m_reader)
+				m_reader->_leave();
+		}
+
+		inline size_type size() const noexcept { return m_size; }
+		inline bool empty() const noexcept { return m_size == 0; }
+		inline const_iterator begin() const noexcept { return m_data; }
+		inline const_iterator end() const noexcept { return m_data + m_size; }
+		inline const value_type &operator[](size_t idx) const { return m_data[idx]; }
+		inline const value_type &front() const { return m_data[0]; }
+		inline const value_type &back() const { return m_data[m_size - 1]; }
+
+		inline const_iterator find(const K &key) const {
+			return search_type::_find(key, m_reader->m_ctx);
+		}
+		inline const_iterator lower_bound(const K &key) const {
+			return search_type::_lower_bound(key, m_reader->m_ctx);
+		}
+		inline const_iterator upper_bound(const K &key) const {
+			return search_type::_upper_bound(key, m_reader->m_ctx);
+		}
+		inline const_iterator at(const K &key) const {
+			auto pos = find(key);
+			if (pos == end())
+				throw std::out_of_range("const_iterator snapshot_tuple_vector::snapshot::at(const K &key) const");
+			return pos;
+		}
+
+	private:
+		snapshot(reader &r, const buffer *b) : m_reader(&r), m_data(b->data), m_size(b->size.load(std::memory_order_acquire)) {
+			search_type::_refresh(m_data, m_size);
+		}
+
+		reader *m_reader;
+		const value_type *m_data;
+		size_t m_size;
+	};
+
+	/**
+	 * \brief registration of a reader thread, claims one of the TUPLE_VECTOR_MAX_READERS slots
+	 *		of the container for its lifetime and keeps the search context of the thread
+	 *		A reader must only be used by one thread at a time.
+	 */
+	class reader {
+		friend class snapshot;
+	public:
+		/// \throw std::runtime_error if all slots are taken
+		explicit reader(const snapshot_tuple_vector &c) : m_c(&c) {
+			for (m_slot = 0; m_slot < TUPLE_VECTOR_MAX_READERS; ++m_slot) {
+				bool free = false;
+				if (c.m_slots[m_slot].used.compare_exchange_strong(free, true))
+					return;
+			}
+			throw std::runtime_error("snapshot_tuple_vector: too many readers");
+		}
+		reader(const reader &) = delete;
+		reader &operator=(const reader &) = delete;
+		~reader() {
+			m_c->m_slots[m_slot].epoch.store(0);
+			m_c->m_slots[m_slot].used.store(false, std::memory_order_release);
+		}
+
+		/**
+		 * \brief snapshot of all elements published so far
+		 *		Further snapshots taken while one is alive stay in the epoch of the first one.
+		 */
+		inline class snapshot snapshot() {
+			slot &s = m_c->m_slots[m_slot];
+			if (m_active++ == 0) {
+				// announce the epoch before loading the buffer, see snapshot_tuple_vector
+				s.epoch.store(m_c->m_epoch.load());
+			}
+			return typename snapshot_tuple_vector::snapshot(*this, m_c->m_buf.load());
+		}
+
+		/// the search context used by all snapshots of this reader
+		inline const context_type &context() const { return m_ctx; }
+
+	private:
+		inline void _leave() {
+			if (--m_active == 0)
+				m_c->m_slots[m_slot].epoch.store(0, std::memory_order_release);
+		}
+
+		const snapshot_tuple_vector *m_c;
+		size_t m_slot;
+		size_t m_active = 0;
+		context_type m_ctx;
+	};
+
+	/// \param capacity initial number of elements the first buffer can hold
+	explicit snapshot_tuple_vector(size_t capacity = 1024) : m_buf(new buffer(capacity ? capacity : 1)) { }
+	snapshot_tuple_vector(const snapshot_tuple_vector &) = delete;
+	snapshot_tuple_vector &operator=(const snapshot_tuple_vector &) = delete;
+	/// all readers must have been destroyed before
+	~snapshot_tuple_vector() {
+		for (auto &r : m_retired)
+			delete r.first;
+		delete m_buf.load();
+	}
+
+	// Writer operations, all of them must be called from the same thread.
+
+	/// number of published elements
+	inline size_type size() const noexcept { return m_buf.load(std::memory_order_relaxed)->size.load(std::memory_order_relaxed); }
+	inline bool empty() const noexcept { return size() == 0; }
+	inline size_type capacity() const noexcept { return m_buf.load(std::memory_order_relaxed)->capacity; }
+	/// make room for n elements, publishes a new buffer if the current one is too small
+	inline void reserve(size_type n) {
+		if (n > capacity())
+			_grow(n);
+	}
+	/// append an element with a key greater than all others and publish it
+	template <typename... Args> inline void emplace_back(const K &key, Args&&... args) {
+		buffer *b = m_buf.load(std::memory_order_relaxed);
+		const size_t n = b->size.load(std::memory_order_relaxed);
+		if (n == b->capacity)
+			b = _grow(2 * n);
+		::new ((void *)(b->data + n)) value_type(std::piecewise_construct, std::forward_as_tuple(key),
+			std::forward_as_tuple(std::forward<Args>(args)...));
+		b->size.store(n + 1, std::memory_order_release);
+	}
+	inline void emplace_back(const value_type &p) {
+		emplace_back(p.first, p.second);
+	}
+	inline void push_back(const value_type &p) {
+		emplace_back(p.first, p.second);
+	}
+	/// number of retired buffers still waiting for readers to leave them
+	inline size_type retired() const noexcept { return m_retired.size(); }
+	/**
+	 * \brief free the retired buffers no reader can be using any more, also done whenever a
+	 *		new buffer is published
+	 */
+	void reclaim() {
+		if (m_retired.empty())
+			return;
+		uint64_t oldest = std::numeric_limits<uint64_t>::max();
+		for (auto &s : m_slots) {
+			uint64_t e = s.epoch.load();
+			if (e && e < oldest)
+				oldest = e;
+		}
+		// a buffer retired in epoch r may still be used by readers which entered in epoch <= r
+		size_t kept = 0;
+		for (auto &r : m_retired) {
+			if (r.second < oldest)
+				delete r.first;
+			else
+				m_retired[kept++] = r;
+		}
+		m_retired.resize(kept);
+	}
+
+private:
+	/// copy all elements into a new buffer of the given capacity, publish and return it
+	buffer *_grow(size_t cap) {
+		buffer *old = m_buf.load(std::memory_order_relaxed);
+		const size_t n = old->size.load(std::memory_order_relaxed);
+		std::unique_ptr<buffer> b(new buffer(std::max(cap, n + 1)));
+		std::uninitialized_copy(old->data, old->data + n, b->data);
+		b->size.store(n, std::memory_order_relaxed);
+		m_retired.reserve(m_retired.size() + 1);
+		m_buf.store(b.get());
+		m_retired.emplace_back(old, m_epoch.fetch_add(1));
+		reclaim();
+		return b.release();
+	}
+
+	/// the current buffer
+	std::atomic<buffer *> m_buf;
+	/// current epoch, incremented whenever a buffer is retired
+	std::atomic<uint64_t> m_epoch{1};
+	/// one slot per registered reader
+	mutable slot m_slots[TUPLE_VECTOR_MAX_READERS];
+	/// retired buffers and the epoch they were retired in, only accessed by the writer
+	std::vector<std::pair<buffer *, uint64_t>> m_retired;
+};
+
+#endif /* __snapshot_tuple_vector_h */
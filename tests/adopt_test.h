@@ -0,0 +1,81 @@
+		// getting an already built vector of pairs into a tuple_vector: element by element,
+		// as a copy, by moving its buffer in, and as a view without any tuple_vector at all
+		vector<pair<K, double>> src(ts);
+		const K probe = ts[ts.size() / 2].first;
+
+		// temporaries of owning containers are rejected, temporary non-owning views are not, even
+		// if they are not trivially copyable
+		struct borrowed {
+			const pair<K, double> *p;
+			size_t n;
+			borrowed(const pair<K, double> *p, size_t n) : p(p), n(n) { }
+			borrowed(const borrowed &b) : p(b.p), n(b.n) { }
+			const pair<K, double> *data() const { return p; }
+			size_t size() const { return n; }
+		};
+		static_assert(!is_constructible<tuple_view<K, double>, vector<pair<K, double>> &&>::value, "vector temporary");
+		static_assert(!is_constructible<tuple_view<K, double>, array<pair<K, double>, 4> &&>::value, "array temporary");
+		static_assert(!is_constructible<tuple_view<K, double>, tuple_vector<K, double> &&>::value, "tuple_vector temporary");
+		static_assert(!is_constructible<tuple_view<K, double>, multi_tuple_vector<K, double> &&>::value, "multi_tuple_vector temporary");
+		static_assert(is_constructible<tuple_view<K, double>, const vector<pair<K, double>> &>::value, "vector");
+		static_assert(is_constructible<tuple_view<K, double>, borrowed &&>::value, "non-owning view temporary");
+		if (tuple_view<K, double>(borrowed(src.data(), src.size())).find(probe) != src.data() + src.size() / 2)
+			abort();
+
+		// moving an indexed series takes the learned index and the aggregate index over without
+		// rebuilding them (recompute() counts every rebuild), and leaves the source empty
+		static_assert(is_nothrow_move_constructible<tuple_vector<K, double>>::value, "tuple_vector move");
+		static_assert(is_nothrow_move_assignable<tuple_vector<K, double>>::value, "tuple_vector move assignment");
+		static_assert(is_nothrow_move_constructible<columnar_tuple_vector<K, double>>::value, "columnar move");
+		{
+			tuple_vector<K, double> indexed(src.cbegin(), src.cend());
+			indexed.build_index();
+			indexed.build_aggregates();
+			const size_t segments = indexed.index_segments();
+			const int recompute = indexed.recompute();
+			const K from = ts[ts.size() / 4].first, to = ts[ts.size() / 2].first;
+			const auto expected = indexed.aggregate(from, to);
+			tuple_vector<K, double> moved(std::move(indexed)), assigned;
+			assigned = std::move(moved);
+			if (!indexed.empty() || indexed.index_segments() != 0 || indexed.aggregate_bytes() != 0 || !moved.empty())
+				abort();
+			if (assigned.index_segments() != segments || assigned.recompute() != recompute || assigned.aggregate_bytes() == 0)
+				abort();
+			const auto a = assigned.aggregate(from, to);
+			if (a.count != expected.count || a.sum != expected.sum || a.min != expected.min || a.max != expected.max)
+				abort();
+			if (assigned.find(probe) != assigned.begin() + ts.size() / 2)
+				abort();
+			// the moved containers can be filled again
+			indexed.emplace_back(ts[0]);
+			if (indexed.find(ts[0].first) != indexed.begin())
+				abort();
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "emplace_back",	[&src,probe]() {
+				tuple_vector<K, double> t;
+				for (const auto &i : src)
+					t.emplace_back(i);
+				if (t.size() != src.size() || t.find(probe) == t.end())
+					abort();
+			}},
+			{ "copy",	[&src,probe]() {
+				tuple_vector<K, double> t(src.cbegin(), src.cend());
+				if (t.size() != src.size() || t.find(probe) == t.end())
+					abort();
+			}},
+			{ "adopt",	[&src,probe]() {
+				const size_t n = src.size();
+				tuple_vector<K, double> t(std::move(src));
+				if (t.size() != n || t.find(probe) == t.end())
+					abort();
+				// hand the buffer back for the next run
+				t.swap(src);
+			}},
+			{ "view",	[&src,probe]() {
+				tuple_view<K, double> t(src);
+				if (t.size() != src.size() || t.find(probe) == t.end())
+					abort();
+			}}
+		});
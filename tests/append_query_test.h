@@ -0,0 +1,31 @@
+		// live feed simulation: every append is followed by lookups of the newest key and a few
+		// older ones, the containers are built from scratch in every run
+		auto rt = cppbench::time(n_tests, {
+			{ "tuple",	[&ts]() {
+				tuple_vector<K, double> tv;
+				for (size_t i = 0; i < ts.size(); i++) {
+					tv.emplace_back(ts[i]);
+					for (size_t j : { i, i - i/8, i/2, i/3 })
+						if (tv.find(ts[j].first) == tv.end())
+							abort();
+				}
+			}},
+			{ "columnar",	[&ts]() {
+				columnar_tuple_vector<K, double> ctv;
+				for (size_t i = 0; i < ts.size(); i++) {
+					ctv.emplace_back(ts[i]);
+					for (size_t j : { i, i - i/8, i/2, i/3 })
+						if (ctv.find(ts[j].first) == ctv.end())
+							abort();
+				}
+			}},
+			{ "map",	[&ts]() {
+				std::map<K, double> map;
+				for (size_t i = 0; i < ts.size(); i++) {
+					map.emplace_hint(map.end(), ts[i].first, ts[i].second);
+					for (size_t j : { i, i - i/8, i/2, i/3 })
+						if (map.find(ts[j].first) == map.end())
+							abort();
+				}
+			}}
+		});
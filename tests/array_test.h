@@ -1,19 +1,25 @@
 		auto rt = cppbench::time(n_tests, {
-			 { "vector", [ts,vec]() {
+			 { "vector", [&ts,&vec]() {
 				size_t i = 0;
 				for (const auto &it : ts)
 					if (vec[i++].second != it.second)
 						abort();
 			}},
-			{ "map",	[ts,&map]() {
+			{ "map",	[&ts,&map]() {
 				for (const auto &it : ts)
 					if (map[it.first] != it.second)
 						abort();
 			}},
-			{ "tuple",	[ts,tv]() {
+			{ "tuple",	[&ts,&tv]() {
 				size_t i = 0;
 				for (const auto &it : ts)
 					if (tv[i++].second != it.second)
 						abort();
+			}},
+			{ "columnar",	[&ts,&ctv]() {
+				size_t i = 0;
+				for (const auto &it : ts)
+					if (ctv[i++].second != it.second)
+						abort();
 			}}
 		});
@@ -0,0 +1,102 @@
+		// backward as-of join of all keys ("trades") against every other key ("quotes"), and of
+		// every 1000th key against all quotes, by a upper_bound() per trade and by asof_join()
+		tuple_vector<K, double> quotes, sparse;
+		for (size_t n = 0; n < ts.size(); n++) {
+			if (n % 2 == 0)
+				quotes.emplace_back(ts[n]);
+			if (n % 1000 == 0)
+				sparse.emplace_back(ts[n]);
+		}
+		auto per_key = [&quotes](const tuple_vector<K, double> &trades, vector<size_t> &idx) {
+			idx.clear();
+			for (const auto &t : trades) {
+				auto it = quotes.upper_bound(t.first);
+				idx.push_back(it == quotes.begin() ? quotes.size() : it - quotes.begin() - 1);
+			}
+		};
+		vector<size_t> expected, expected_sparse, idx;
+		per_key(tv, expected);
+		per_key(sparse, expected_sparse);
+
+		// every direction, with tolerances just below, at and just above a gap between the keys,
+		// against a brute-force scan of right for every left key
+		{
+			vector<pair<K, double>> lv, rv;
+			mt19937 rng(ts.size());
+			for (size_t n = 0; n < min<size_t>(20000, ts.size()); n++) {
+				if (rng() % 4 == 0)
+					lv.push_back(ts[n]);
+				if (rng() % 16 == 0)
+					rv.push_back(ts[n]);
+			}
+			tuple_vector<K, double> left(lv.begin(), lv.end()), right(rv.begin(), rv.end());
+			const key<K> kf;
+			auto brute = [&lv,&rv,&kf](asof_direction dir, double tol) {
+				vector<size_t> res;
+				for (const auto &l : lv) {
+					// last element not greater and first element not less than the left key
+					size_t back = rv.size(), fwd = rv.size();
+					for (size_t i = 0; i < rv.size(); i++) {
+						if (!(l.first < rv[i].first))
+							back = i;
+						if (!(rv[i].first < l.first) && fwd == rv.size())
+							fwd = i;
+					}
+					double bd = back < rv.size() ? kf(l.first) - kf(rv[back].first) : 0;
+					double fd = fwd < rv.size() ? kf(rv[fwd].first) - kf(l.first) : 0;
+					bool b = back < rv.size() && bd <= tol, f = fwd < rv.size() && fd <= tol;
+					size_t idx = rv.size();
+					if (dir == asof_direction::backward)
+						idx = b ? back : idx;
+					else if (dir == asof_direction::forward)
+						idx = f ? fwd : idx;
+					else if (b && (!f || bd <= fd))
+						idx = back;
+					else if (f)
+						idx = fwd;
+					res.push_back(idx);
+				}
+				return res;
+			};
+			// the largest distance of a left key to the right key before it
+			double gap = 0;
+			for (const auto &l : lv) {
+				auto it = std::upper_bound(rv.begin(), rv.end(), l,
+					[](const pair<K, double> &a, const pair<K, double> &b) { return a.first < b.first; });
+				if (it != rv.begin())
+					gap = max(gap, kf(l.first) - kf((it - 1)->first));
+			}
+			for (double tol : { numeric_limits<double>::infinity(), 0.0, 1.0,
+					nextafter(gap, 0.0), gap, nextafter(gap, numeric_limits<double>::infinity()) })
+				for (auto dir : { asof_direction::backward, asof_direction::forward, asof_direction::nearest }) {
+					vector<size_t> res;
+					asof_join(left, right, back_inserter(res), dir, tol);
+					if (res != brute(dir, tol))
+						abort();
+				}
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "upper_bound loop",	[&per_key,&tv,&idx,&expected]() {
+				per_key(tv, idx);
+				if (idx != expected)
+					abort();
+			}},
+			{ "asof_join",	[&quotes,&tv,&idx,&expected]() {
+				idx.clear();
+				asof_join(tv, quotes, back_inserter(idx));
+				if (idx != expected)
+					abort();
+			}},
+			{ "upper_bound loop sparse",	[&per_key,&sparse,&idx,&expected_sparse]() {
+				per_key(sparse, idx);
+				if (idx != expected_sparse)
+					abort();
+			}},
+			{ "asof_join sparse",	[&quotes,&sparse,&idx,&expected_sparse]() {
+				idx.clear();
+				asof_join(sparse, quotes, back_inserter(idx));
+				if (idx != expected_sparse)
+					abort();
+			}}
+		});
@@ -0,0 +1,89 @@
+		// building a tuple_vector from 4 unsorted feeds: single-threaded sort vs. bulk_load()
+		vector<vector<pair<K, double>>> feeds(4);
+		{
+			vector<pair<K, double>> shuffled(ts);
+			shuffle(shuffled.begin(), shuffled.end(), mt19937(shuffled.size()));
+			for (size_t i = 0; i < shuffled.size(); i++)
+				feeds[i % feeds.size()].push_back(shuffled[i]);
+		}
+		typedef typename vector<pair<K, double>>::const_iterator feed_iterator;
+		vector<pair<feed_iterator, feed_iterator>> ranges;
+		for (const auto &f : feeds)
+			ranges.emplace_back(f.cbegin(), f.cend());
+
+		{
+			// the same series with every third key repeated, the value of every element is its
+			// position in the input, so the survivor of keep_first has the smallest and the one of
+			// keep_last the largest value of its key
+			vector<vector<pair<K, double>>> dfeeds(4);
+			{
+				vector<pair<K, double>> shuffled(ts);
+				for (size_t i = 0; i < ts.size(); i += 3)
+					shuffled.push_back(ts[i]);
+				shuffle(shuffled.begin(), shuffled.end(), mt19937(shuffled.size()));
+				for (size_t i = 0; i < shuffled.size(); i++)
+					dfeeds[i % dfeeds.size()].push_back(shuffled[i]);
+			}
+			vector<double> first_val(ts.size(), -1), last_val(ts.size(), -1);
+			double order = 0;
+			for (auto &f : dfeeds)
+				for (auto &e : f) {
+					e.second = order++;
+					size_t i = lower_bound(ts.begin(), ts.end(), e, [](const pair<K, double> &a, const pair<K, double> &b) { return a.first < b.first; }) - ts.begin();
+					if (first_val[i] < 0)
+						first_val[i] = e.second;
+					last_val[i] = e.second;
+				}
+			vector<pair<feed_iterator, feed_iterator>> dranges;
+			for (const auto &f : dfeeds)
+				dranges.emplace_back(f.cbegin(), f.cend());
+			for (unsigned threads : { 1u, 2u, 4u }) {
+				tuple_vector<K, double> kf, kl;
+				bulk_load(kf, dranges, duplicate_policy::keep_first, threads);
+				bulk_load(kl, dranges, duplicate_policy::keep_last, threads);
+				if (kf.size() != ts.size() || kl.size() != ts.size())
+					abort();
+				for (size_t i = 0; i < ts.size(); i++)
+					if (kf[i].first != ts[i].first || kf[i].second != first_val[i] || kl[i].first != ts[i].first || kl[i].second != last_val[i])
+						abort();
+				bool thrown = false;
+				try {
+					tuple_vector<K, double> ke;
+					bulk_load(ke, dranges, duplicate_policy::error, threads);
+				} catch (const runtime_error &) {
+					thrown = true;
+				}
+				if (!thrown)
+					abort();
+			}
+			tuple_vector<K, double> ke;
+			bulk_load(ke, ranges, duplicate_policy::error);
+			if (ke.size() != ts.size())
+				abort();
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "sort",	[&feeds,&ts]() {
+				vector<pair<K, double>> v;
+				for (const auto &f : feeds)
+					v.insert(v.end(), f.begin(), f.end());
+				stable_sort(v.begin(), v.end(), [](const pair<K, double> &a, const pair<K, double> &b) { return a.first < b.first; });
+				v.erase(unique(v.begin(), v.end(), [](const pair<K, double> &a, const pair<K, double> &b) { return a.first == b.first; }), v.end());
+				tuple_vector<K, double> btv;
+				btv = std::move(v);
+				if (btv.size() != ts.size())
+					abort();
+			}},
+			{ "bulk_load 1 thread",	[&ranges,&ts]() {
+				tuple_vector<K, double> btv;
+				bulk_load(btv, ranges, duplicate_policy::keep_first, 1);
+				if (btv.size() != ts.size())
+					abort();
+			}},
+			{ "bulk_load",	[&ranges,&ts]() {
+				tuple_vector<K, double> btv;
+				bulk_load(btv, ranges, duplicate_policy::keep_first);
+				if (btv.size() != ts.size() || find_unordered(btv.begin(), btv.end()) != btv.size())
+					abort();
+			}}
+		});
@@ -0,0 +1,95 @@
+		// appends without and with chunked storage, then find() in random order
+		chunked_tuple_vector<K, double> chv;
+		for (const auto &i : ts)
+			chv.emplace_back(i.first, i.second);
+
+		// lookups against a std::vector reference with small chunks, so that many keys fall on or
+		// right next to a chunk boundary - every other key of ts is left out, as is the first one
+		{
+			vector<pair<K, double>> ref;
+			for (size_t i = 1; i < ts.size() && ref.size() < 4000; i += 2)
+				ref.push_back(ts[i]);
+			chunked_tuple_vector<K, double, no_search_stats, 64> small;
+			small.emplace_back(ref[0]);
+			auto first = small.begin();
+			const auto *front = &small.front();
+			for (size_t i = 1; i < ref.size(); i++)
+				small.emplace_back(ref[i]);
+			// appends never move the elements, so iterators and references taken before stay valid
+			if (&small.front() != front || &*first != front || first->first != ref[0].first || first != small.begin())
+				abort();
+			auto lower = [](const pair<K, double> &a, const K &b) { return a.first < b; };
+			auto upper = [](const K &a, const pair<K, double> &b) { return a < b.first; };
+			// compare against the first n elements of ref, with the keys before, between and after them
+			auto check = [&](size_t n) {
+				if (small.size() != n || (n && small.back().first != ref[n - 1].first))
+					abort();
+				for (size_t i = 0; i < 2 * n + 2 && i < ts.size(); i++) {
+					const K &k = ts[i].first;
+					size_t lb = std::lower_bound(ref.begin(), ref.begin() + n, k, lower) - ref.begin();
+					size_t ub = std::upper_bound(ref.begin(), ref.begin() + n, k, upper) - ref.begin();
+					if ((size_t)(small.lower_bound(k) - small.begin()) != lb)
+						abort();
+					if ((size_t)(small.upper_bound(k) - small.begin()) != ub)
+						abort();
+					if ((size_t)(small.find(k) - small.begin()) != (lb != ub ? lb : n))
+						abort();
+				}
+			};
+			check(ref.size());
+			// pop_back() down across several chunk boundaries, then append again
+			while (small.size() > ref.size() - 300) {
+				small.pop_back();
+				if (small.size() % 64 <= 1)
+					check(small.size());
+			}
+			for (size_t i = small.size(); i < ref.size(); i++)
+				small.emplace_back(ref[i]);
+			check(ref.size());
+			if (&small.front() != front)
+				abort();
+
+			// assignment keeps the learned index of the chunk directory, just like copy construction
+			small.build_index();
+			decltype(small) copied, tmp(small), moved;
+			copied = small;
+			moved = std::move(tmp);
+			for (const auto *c : { &copied, &moved }) {
+				if (c->index_segments() != small.index_segments() || c->size() != small.size())
+					abort();
+				for (size_t i = 0; i < ref.size(); i += 7)
+					if (c->find(ref[i].first) != c->begin() + i)
+						abort();
+			}
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "tuple emplace_back",	[&ts]() {
+				tuple_vector<K, double> tv;
+				for (const auto &i : ts)
+					tv.emplace_back(i.first, i.second);
+				if (tv.size() != ts.size())
+					abort();
+			}},
+			{ "chunked emplace_back",	[&ts]() {
+				chunked_tuple_vector<K, double> chv;
+				for (const auto &i : ts)
+					chv.emplace_back(i.first, i.second);
+				if (chv.size() != ts.size())
+					abort();
+			}},
+			{ "tuple find",	[&shuffled,&tv]() {
+				for (auto &k : shuffled) {
+					auto it = tv.find(k);
+					if (it == tv.end() || it->first != k)
+						abort();
+				}
+			}},
+			{ "chunked find",	[&shuffled,&chv]() {
+				for (auto &k : shuffled) {
+					auto it = chv.find(k);
+					if (it == chv.end() || it->first != k)
+						abort();
+				}
+			}}
+		});
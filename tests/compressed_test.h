@@ -0,0 +1,95 @@
+		// memory per element and find() in order and in random order with compressed keys
+		compressed_tuple_vector<K, double> cptv(tv.begin(), tv.end());
+		cout << "bytes per element: tuple " << sizeof(typename tuple_vector<K, double>::value_type)
+			<< ", compressed " << (double)(cptv.key_bytes() + cptv.size() * sizeof(double)) / cptv.size()
+			<< " (keys " << (double)cptv.key_bytes() / cptv.size() << ")" << endl;
+
+		// keys with random gaps, so the blocks have residuals to bit-pack and decode, cross-checked
+		// against std::lower_bound for randomly chosen keys
+		vector<pair<K, double>> gts;
+		vector<K> queries;
+		vector<size_t> expected;
+		{
+			mt19937 rng(ts.size());
+			K dt = 0;
+			for (size_t n = 0; n < ts.size(); n++, dt++) {
+				gts.emplace_back(dt, n);
+				for (size_t gap = rng() % 8 ? 0 : rng() % 64; gap; --gap)
+					dt++;
+			}
+			for (size_t n = 0; n < ts.size(); n++) {
+				K q = gts[rng() % gts.size()].first;
+				if (rng() % 2)
+					q++;
+				queries.push_back(q);
+				expected.push_back(std::lower_bound(gts.begin(), gts.end(), q,
+					[](const pair<K, double> &a, const K &b) { return a.first < b; }) - gts.begin());
+			}
+		}
+		tuple_vector<K, double> gtv(gts.begin(), gts.end());
+		compressed_tuple_vector<K, double> gcptv(gts.begin(), gts.end());
+		for (size_t i = 0; i < gts.size(); i++)
+			if (gcptv[i].first != gts[i].first || gcptv[i].second != gts[i].second)
+				abort();
+		// moving takes the blocks over instead of copying them and leaves the source empty
+		{
+			compressed_tuple_vector<K, double> tmp(gcptv);
+			const double *values = tmp.values().data();
+			compressed_tuple_vector<K, double> moved(std::move(tmp)), assigned;
+			if (moved.values().data() != values || !tmp.empty() || tmp.find(gts[0].first) != tmp.end())
+				abort();
+			assigned = std::move(moved);
+			if (assigned.values().data() != values || !moved.empty() || assigned.size() != gts.size())
+				abort();
+			for (size_t i = 0; i < queries.size(); i += 11)
+				if ((size_t)(assigned.lower_bound(queries[i]) - assigned.begin()) != expected[i])
+					abort();
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "tuple",	[&ts,&tv]() {
+				for (auto &i : ts) {
+					auto it = tv.find(i.first);
+					if (it == tv.end() || it->first != i.first)
+						abort();
+				}
+			}},
+			{ "compressed",	[&ts,&cptv]() {
+				for (auto &i : ts) {
+					auto it = cptv.find(i.first);
+					if (it == cptv.end() || it->first != i.first)
+						abort();
+				}
+			}},
+			{ "tuple shuffled",	[&shuffled,&tv]() {
+				for (auto &k : shuffled) {
+					auto it = tv.find(k);
+					if (it == tv.end() || it->first != k)
+						abort();
+				}
+			}},
+			{ "compressed shuffled",	[&shuffled,&cptv]() {
+				for (auto &k : shuffled) {
+					auto it = cptv.find(k);
+					if (it == cptv.end() || it->first != k)
+						abort();
+				}
+			}},
+			{ "tuple gaps lower_bound",	[&queries,&expected,&gtv]() {
+				for (size_t i = 0; i < queries.size(); i++)
+					if ((size_t)(gtv.lower_bound(queries[i]) - gtv.begin()) != expected[i])
+						abort();
+			}},
+			{ "compressed gaps lower_bound",	[&queries,&expected,&gcptv]() {
+				for (size_t i = 0; i < queries.size(); i++)
+					if ((size_t)(gcptv.lower_bound(queries[i]) - gcptv.begin()) != expected[i])
+						abort();
+			}},
+			{ "compressed gaps find",	[&gts,&gcptv]() {
+				for (auto &i : gts) {
+					auto it = gcptv.find(i.first);
+					if (it == gcptv.end() || it->first != i.first || it->second != i.second)
+						abort();
+				}
+			}}
+		});
@@ -0,0 +1,31 @@
+		// the keys of ts are split into one block per thread and all threads look up their block in
+		// the same tuple_vector - each thread uses its own search_context, the "mutex" entry
+		// shows the alternative of serialising all lookups on the built-in context
+		auto parallel_find = [&ts,&tv](size_t n_threads, bool lock) {
+			return [&ts,&tv,n_threads,lock]() {
+				mutex mtx;
+				vector<thread> threads;
+				for (size_t t = 0; t < n_threads; t++)
+					threads.emplace_back([&ts,&tv,&mtx,t,n_threads,lock]() {
+						search_context ctx;
+						for (size_t i = t * ts.size() / n_threads; i < (t + 1) * ts.size() / n_threads; i++) {
+							if (lock) {
+								lock_guard<mutex> guard(mtx);
+								if (tv.find(ts[i].first) == tv.end())
+									abort();
+							} else if (tv.find(ts[i].first, ctx) == tv.end())
+								abort();
+						}
+					});
+				for (auto &t : threads)
+					t.join();
+			};
+		};
+
+		auto rt = cppbench::time(n_tests, {
+			{ "mutex 4 threads",	parallel_find(4, true) },
+			{ "tuple 1 thread",		parallel_find(1, false) },
+			{ "tuple 2 threads",	parallel_find(2, false) },
+			{ "tuple 4 threads",	parallel_find(4, false) },
+			{ "tuple 8 threads",	parallel_find(8, false) }
+		});
@@ -0,0 +1,52 @@
+		// replay: a clock runs over the series and asks for each element's key and the key just
+		// after it, in order - repeated lower_bound() vs. a cursor galloping from its last position
+		vector<K> clock;
+		for (auto &i : ts) {
+			K dt = i.first;
+			clock.push_back(dt);
+			dt++;
+			if (dt > ts.crbegin()->first)
+				break;
+			clock.push_back(dt);
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "tuple lower_bound",	[&clock,&tv]() {
+				for (auto &k : clock) {
+					auto it = tv.lower_bound(k);
+					if (it == tv.end() || (*it).first < k)
+						abort();
+				}
+			}},
+			{ "tuple cursor",	[&clock,&tv]() {
+				auto cur = make_cursor(tv);
+				for (auto &k : clock) {
+					auto it = cur.advance_to(k);
+					if (it == tv.end() || (*it).first < k || (it != tv.begin() && !((*(it - 1)).first < k)))
+						abort();
+				}
+			}},
+			{ "tuple cursor latest",	[&clock,&tv]() {
+				auto cur = make_cursor(tv);
+				for (auto &k : clock) {
+					auto it = cur.latest(k);
+					if (it == tv.end() || k < (*it).first || (it + 1 != tv.end() && !(k < (*(it + 1)).first)))
+						abort();
+				}
+			}},
+			{ "columnar lower_bound",	[&clock,&ctv]() {
+				for (auto &k : clock) {
+					auto it = ctv.lower_bound(k);
+					if (it == ctv.end() || (*it).first < k)
+						abort();
+				}
+			}},
+			{ "columnar cursor",	[&clock,&ctv]() {
+				auto cur = make_cursor(ctv);
+				for (auto &k : clock) {
+					auto it = cur.advance_to(k);
+					if (it == ctv.end() || (*it).first < k || (it != ctv.begin() && !((*(it - 1)).first < k)))
+						abort();
+				}
+			}}
+		});
@@ -0,0 +1,116 @@
+		// late inserts: a share of the elements arrives after the rest of the series and is
+		// inserted in random order, into a tuple_vector and into a delta_tuple_vector
+		auto late_split = [&ts](size_t every, vector<pair<K, double>> &base, vector<pair<K, double>> &late) {
+			for (size_t i = 0; i < ts.size(); i++)
+				(i % every == every / 2 ? late : base).push_back(ts[i]);
+			shuffle(late.begin(), late.end(), mt19937(late.size()));
+		};
+		vector<pair<K, double>> base_1, late_1, base_10, late_10, base_100, late_100;
+		late_split(10000, base_1, late_1);		// 0.01%
+		late_split(1000, base_10, late_10);		// 0.1%
+		late_split(100, base_100, late_100);	// 1%
+
+		auto tuple_late = [](const vector<pair<K, double>> &base, const vector<pair<K, double>> &late) {
+			tuple_vector<K, double> lv;
+			lv.assign(base.cbegin(), base.cend());
+			for (const auto &e : late)
+				lv.insert(lv.lower_bound(e.first), e);
+			for (const auto &e : late)
+				if (lv.find(e.first) == lv.end())
+					abort();
+		};
+		auto delta_late = [](const vector<pair<K, double>> &base, const vector<pair<K, double>> &late) {
+			delta_tuple_vector<K, double> lv;
+			lv.reserve(base.size() + late.size());
+			for (const auto &e : base)
+				lv.emplace_back(e);
+			for (const auto &e : late)
+				if (!lv.insert(e))
+					abort();
+			for (const auto &e : late)
+				if (lv.find(e.first) == lv.end())
+					abort();
+		};
+
+		// the merged view of main series and buffer: iteration both ways, bounds on present and
+		// absent keys and lookups after compact(), against a sorted reference
+		{
+			// every third key is left out, so there are absent keys between all others
+			vector<pair<K, double>> ref, base, late;
+			for (size_t i = 0; i < 3000; i++)
+				if (i % 3 != 1)
+					ref.push_back(ts[i]);
+			for (size_t i = 0; i < ref.size(); i++)
+				(i % 7 == 3 ? late : base).push_back(ref[i]);
+			shuffle(late.begin(), late.end(), mt19937(late.size()));
+			delta_tuple_vector<K, double> dv(late.size());
+			for (const auto &e : base)
+				dv.emplace_back(e);
+			for (const auto &e : late)
+				if (!dv.insert(e))
+					abort();
+			if (dv.delta_size() != late.size() || dv.size() != ref.size())
+				abort();
+			auto check = [&ts,&ref](const delta_tuple_vector<K, double> &d) {
+				size_t n = 0;
+				for (auto it = d.begin(); it != d.end(); ++it, ++n)
+					if (n == ref.size() || it->first != ref[n].first)
+						abort();
+				if (n != ref.size())
+					abort();
+				for (auto it = d.end(); it != d.begin(); )
+					if ((--it)->first != ref[--n].first)
+						abort();
+				auto less = [](const pair<K, double> &a, const K &b) { return a.first < b; };
+				auto greater = [](const K &a, const pair<K, double> &b) { return a < b.first; };
+				for (size_t i = 0; i < 3000; i++) {
+					const K &k = ts[i].first;
+					auto lb = std::lower_bound(ref.begin(), ref.end(), k, less);
+					auto ub = std::upper_bound(ref.begin(), ref.end(), k, greater);
+					auto dlb = d.lower_bound(k), dub = d.upper_bound(k), df = d.find(k);
+					if ((lb == ref.end()) != (dlb == d.end()) || (lb != ref.end() && dlb->first != lb->first))
+						abort();
+					if ((ub == ref.end()) != (dub == d.end()) || (ub != ref.end() && dub->first != ub->first))
+						abort();
+					bool present = lb != ref.end() && lb->first == k;
+					if (present ? df != dlb : df != d.end())
+						abort();
+				}
+			};
+			check(dv);
+			dv.compact();
+			if (dv.delta_size() != 0 || dv.main().size() != ref.size())
+				abort();
+			check(dv);
+
+			// tuple_vector::merge() of overlapping keys, before, inside and after the series:
+			// every element with a key already in the series replaces it
+			tuple_vector<K, double> mv;
+			vector<pair<K, double>> more, merged;
+			for (size_t i = 100; i < 1000; i += 2)
+				mv.emplace_back(ts[i].first, 1.0);
+			for (size_t i = 0; i < 1200; i += 3)
+				more.emplace_back(ts[i].first, 2.0);
+			for (size_t i = 0; i < 1200; i++)
+				if (i % 3 == 0)
+					merged.emplace_back(ts[i].first, 2.0);
+				else if (i % 2 == 0 && i >= 100 && i < 1000)
+					merged.emplace_back(ts[i].first, 1.0);
+			mv.merge(more.begin(), more.end());
+			if (mv.size() != merged.size())
+				abort();
+			for (size_t i = 0; i < merged.size(); i++) {
+				if (mv.begin()[i] != merged[i])
+					abort();
+				auto it = mv.find(merged[i].first);
+				if (it == mv.end() || it->second != merged[i].second)
+					abort();
+			}
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "tuple 0.01% late",	[&]() { tuple_late(base_1, late_1); }},
+			{ "delta 0.01% late",	[&]() { delta_late(base_1, late_1); }},
+			{ "delta 0.1% late",	[&]() { delta_late(base_10, late_10); }},
+			{ "delta 1% late",		[&]() { delta_late(base_100, late_100); }}
+		});
@@ -1,17 +1,51 @@
+		// a value constructor which throws must not leave the key column one element longer
+		{
+			struct failing {
+				operator double() const { throw invalid_argument("no value"); }
+			};
+			columnar_tuple_vector<K, double> cv;
+			for (size_t i = 0; i < 1000; i++) {
+				// throw right when the key column has to grow, so it is reallocated first
+				if (cv.size() == cv.capacity()) {
+					try {
+						cv.emplace_back(ts[i].first, failing());
+						abort();
+					} catch (const invalid_argument &) {
+					}
+					if (cv.keys().size() != i || cv.values().size() != i)
+						abort();
+					if (i && cv.find(ts[i - 1].first) != cv.end() - 1)
+						abort();
+				}
+				cv.emplace_back(ts[i].first, ts[i].second);
+			}
+			for (size_t i = 0; i < 1000; i++) {
+				auto it = cv.find(ts[i].first);
+				if (it == cv.end() || it->first != ts[i].first || it->second != ts[i].second)
+					abort();
+			}
+		}
+
 		auto rt = cppbench::time(n_tests, {
-			{ "tuple",	[ts,&tv]() {
+			{ "tuple",	[&ts,&tv]() {
 				tv.clear();
 				tv.reserve(ts.size());
 				for (const auto &it : ts)
 					tv.emplace_back(it);
 			}},
-			{ "vector", [ts,&vec]() {
+			{ "columnar",	[&ts,&ctv]() {
+				ctv.clear();
+				ctv.reserve(ts.size());
+				for (const auto &it : ts)
+					ctv.emplace_back(it);
+			}},
+			{ "vector", [&ts,&vec]() {
 				vec.clear();
 				vec.reserve(ts.size());
 				for (const auto &it : ts)
 					vec.emplace_back(it);
 			}},
-			{ "map",	[ts,&map]() {
+			{ "map",	[&ts,&map]() {
 				map.clear();
 				for (const auto &it : ts)
 					map.emplace_hint(map.end(), it.first, it.second);
@@ -1,12 +1,18 @@
+		// keys to look up in order and in random order, plus the indices returned by find_many()
+		vector<K> keys;
+		for (const auto &i : ts)
+			keys.push_back(i.first);
+		vector<size_t> idx(keys.size());
+
 		auto rt = cppbench::time(n_tests, {
-			{ "map",	[ts,map]() {
+			{ "map",	[&ts,&map]() {
 				for (auto &i : ts) {
 					auto it = map.find(i.first);
 					if (it->first != i.first)
 						abort();
 				}
 			}},
-			{ "tuple",	[ts,&tv]() {
+			{ "tuple",	[&ts,&tv]() {
 				for (auto &i : ts) {
 					auto it = tv.find(i.first);
 					if (it == tv.end())
@@ -14,5 +20,39 @@
 					if ((*it).first != i.first)
 						abort();
 				}
+			}},
+			{ "tuple shuffled",	[&shuffled,&tv]() {
+				for (auto &k : shuffled) {
+					auto it = tv.find(k);
+					if (it == tv.end() || (*it).first != k)
+						abort();
+				}
+			}},
+			{ "tuple batch",	[&keys,&idx,&tv]() {
+				tv.find_many(keys.begin(), keys.end(), idx.begin());
+				for (size_t i = 0; i < keys.size(); i++)
+					if (idx[i] != i)
+						abort();
+			}},
+			{ "tuple batch shuffled",	[&shuffled,&idx,&tv]() {
+				tv.find_many(shuffled.begin(), shuffled.end(), idx.begin());
+				for (size_t i = 0; i < shuffled.size(); i++)
+					if (idx[i] == tv.size() || tv[idx[i]].first != shuffled[i])
+						abort();
+			}},
+			{ "columnar batch",	[&keys,&idx,&ctv]() {
+				ctv.find_many(keys.begin(), keys.end(), idx.begin());
+				for (size_t i = 0; i < keys.size(); i++)
+					if (idx[i] != i)
+						abort();
+			}},
+			{ "columnar",	[&ts,&ctv]() {
+				for (auto &i : ts) {
+					auto it = ctv.find(i.first);
+					if (it == ctv.end())
+						abort();
+					if ((*it).first != i.first || (*it).second != i.second)
+						abort();
+				}
 			}}
 		});
@@ -0,0 +1,89 @@
+		// find() in random order with the series on 4K pages and on huge pages, see allocators.h
+		tuple_vector<K, double, no_search_stats, huge_page_allocator<pair<K, double>, huge_page_mode::none>> tv4k;
+		tuple_vector<K, double, no_search_stats, huge_page_allocator<pair<K, double>, huge_page_mode::madvise>> tvthp;
+		tuple_vector<K, double, no_search_stats, huge_page_allocator<pair<K, double>, huge_page_mode::hugetlb>> tvtlb;
+		columnar_tuple_vector<K, double, no_search_stats, huge_page_allocator<pair<K, double>>> ctvthp;
+		tv4k.reserve(ts.size());
+		tvthp.reserve(ts.size());
+		tvtlb.reserve(ts.size());
+		for (const auto &i : ts) {
+			tv4k.emplace_back(i.first, i.second);
+			tvthp.emplace_back(i.first, i.second);
+			tvtlb.emplace_back(i.first, i.second);
+			ctvthp.emplace_back(i.first, i.second);
+		}
+
+		// many small per-instrument series sharing one arena
+		monotonic_arena arena;
+		typedef tuple_vector<K, double, no_search_stats, arena_allocator<pair<K, double>>> arena_series;
+		vector<arena_series> instruments;
+		vector<K> firsts;
+		const size_t n_instruments = min<size_t>(64, ts.size()), per_instrument = ts.size() / n_instruments;
+		instruments.reserve(n_instruments);
+		for (size_t n = 0; n < n_instruments; n++) {
+			instruments.emplace_back(arena_allocator<pair<K, double>>(arena));
+			instruments.back().reserve(per_instrument);
+			firsts.push_back(ts[n * per_instrument].first);
+			for (size_t i = n * per_instrument; i < (n + 1) * per_instrument; i++)
+				instruments.back().emplace_back(ts[i].first, ts[i].second);
+		}
+
+		{
+			// an arena within a caller's buffer can be filled again after release()
+			alignas(64) static char buf[1024];
+			monotonic_arena fixed(buf, sizeof(buf));
+			for (int round = 0; round < 3; round++) {
+				if (fixed.allocate(sizeof(buf), 64) != buf || fixed.used() != sizeof(buf))
+					abort();
+				bool full = false;
+				try {
+					fixed.allocate(1, 1);
+				} catch (const bad_alloc &) {
+					full = true;
+				}
+				if (!full)
+					abort();
+				fixed.release();
+				if (fixed.used())
+					abort();
+			}
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "tuple 4K pages",	[&shuffled,&tv4k]() {
+				for (auto &k : shuffled) {
+					auto it = tv4k.find(k);
+					if (it == tv4k.end() || it->first != k)
+						abort();
+				}
+			}},
+			{ "tuple transparent huge pages",	[&shuffled,&tvthp]() {
+				for (auto &k : shuffled) {
+					auto it = tvthp.find(k);
+					if (it == tvthp.end() || it->first != k)
+						abort();
+				}
+			}},
+			{ "tuple hugetlb pages",	[&shuffled,&tvtlb]() {
+				for (auto &k : shuffled) {
+					auto it = tvtlb.find(k);
+					if (it == tvtlb.end() || it->first != k)
+						abort();
+				}
+			}},
+			{ "columnar transparent huge pages",	[&shuffled,&ctvthp]() {
+				for (auto &k : shuffled) {
+					auto it = ctvthp.find(k);
+					if (it == ctvthp.end() || it->first != k)
+						abort();
+				}
+			}},
+			{ "arena series",	[&shuffled,&instruments,&firsts]() {
+				for (auto &k : shuffled) {
+					auto &series = instruments[upper_bound(firsts.begin(), firsts.end(), k) - firsts.begin() - 1];
+					auto it = series.find(k);
+					if (k <= series.back().first && (it == series.end() || it->first != k))
+						abort();
+				}
+			}}
+		});
@@ -1,5 +1,5 @@
 		auto rt = cppbench::time(n_tests, {
-			 { "vector", [ts,vec]() {
+			 { "vector", [&ts,&vec]() {
 				auto it = ts.begin();
 				for (auto &x : vec) {
 					if (x.first != it->first)
@@ -7,7 +7,7 @@
 					++it;
 				}
 			}},
-			{ "map",	[ts,map]() {
+			{ "map",	[&ts,&map]() {
 				auto x = map.begin();
 				auto i = ts.begin();
 				for (; i != ts.end(); ++i, ++x) {
@@ -16,12 +16,20 @@
 				}
 			
 			}},
-			{ "tuple",	[ts,tv]() {
+			{ "tuple",	[&ts,&tv]() {
 				auto x = tv.begin();
 				auto i = ts.begin();
 				for (; i != ts.end(); ++i, ++x) {
 					if (x->first != i->first)
 						abort();
 				}
+			}},
+			{ "columnar",	[&ts,&ctv]() {
+				auto x = ctv.begin();
+				auto i = ts.begin();
+				for (; i != ts.end(); ++i, ++x) {
+					if (x->first != i->first)
+						abort();
+				}
 			}}
 		});
@@ -0,0 +1,55 @@
+		// find() and lower_bound() in random order with and without the learned index
+		tuple_vector<K, double> ltv(tv);
+		ltv.build_index();
+		cout << "learned index: " << ltv.index_segments() << " segments, " << ltv.index_bytes() << " bytes ("
+			<< ltv.index_segment_bytes() << " bytes per segment)" << endl;
+		// absent keys between the elements, keys before the front and after the back, on keys with
+		// bursts and gaps of all sizes, so many lookups land right at the edges of a segment window
+		{
+			vector<pair<K, double>> ref;
+			mt19937 rng(ts.size());
+			const size_t bound = min<size_t>(100000, ts.size() - 10);
+			for (size_t i = 10; i < bound; ) {
+				ref.push_back(ts[i]);
+				size_t r = rng() % 100;
+				i += r < 80 ? 1 : r < 95 ? 2 + rng() % 10 : 50 + rng() % 1000;
+			}
+			const size_t n_keys = bound + 10;
+			auto less = [](const pair<K, double> &a, const K &b) { return a.first < b; };
+			for (size_t epsilon : { 1, 4, 64 }) {
+				tuple_vector<K, double> etv(ref.begin(), ref.end());
+				etv.build_index(epsilon);
+				for (size_t i = 0; i < n_keys; i++) {
+					const K &k = ts[i].first;
+					size_t lb = std::lower_bound(ref.begin(), ref.end(), k, less) - ref.begin();
+					bool present = lb < ref.size() && ref[lb].first == k;
+					if ((size_t)(etv.lower_bound(k) - etv.begin()) != lb)
+						abort();
+					if ((size_t)(etv.find(k) - etv.begin()) != (present ? lb : ref.size()))
+						abort();
+					if ((size_t)(etv.upper_bound(k) - etv.begin()) != (present ? lb + 1 : lb))
+						abort();
+				}
+			}
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "tuple",	[&shuffled,&tv]() {
+				for (auto &k : shuffled) {
+					auto it = tv.find(k);
+					if (it == tv.end() || (*it).first != k)
+						abort();
+					if (tv.lower_bound(k) != it)
+						abort();
+				}
+			}},
+			{ "learned",	[&shuffled,&ltv]() {
+				for (auto &k : shuffled) {
+					auto it = ltv.find(k);
+					if (it == ltv.end() || (*it).first != k)
+						abort();
+					if (ltv.lower_bound(k) != it)
+						abort();
+				}
+			}}
+		});
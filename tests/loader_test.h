@@ -0,0 +1,126 @@
+		// load the series from a tab separated text file and from a binary file, keys are
+		// written as the integers of their key_codec
+		const string text_file = "loader_test.txt", binary_file = "loader_test.bin";
+		{
+			FILE *txt = fopen(text_file.c_str(), "w"), *bin = fopen(binary_file.c_str(), "wb");
+			if (!txt || !bin)
+				abort();
+			fprintf(txt, "time\tvalue\n");
+			for (const auto &i : ts) {
+				int64_t code = key_codec<K>::encode(i.first);
+				fprintf(txt, "%lld\t%.7f\n", (long long)code, i.second);
+				fwrite(&i.first, sizeof(K), 1, bin);
+				fwrite(&i.second, sizeof(double), 1, bin);
+			}
+			fclose(txt);
+			fclose(bin);
+		}
+		text_format fmt;
+		fmt.header_lines = 1;
+		auto check = [&ts](const tuple_vector<K, double> &lv) {
+			if (lv.size() != ts.size())
+				abort();
+			for (size_t i = 0; i < ts.size(); i++)
+				if (lv[i].first != ts[i].first || lv[i].second != ts[i].second)
+					abort();
+		};
+
+		{
+			// small files for CRLF line endings, commas, a missing final newline and the errors
+			const string small_file = "loader_test_small.txt";
+			string c[3];
+			for (size_t i = 0; i < 3; i++)
+				c[i] = to_string((long long)key_codec<K>::encode(ts[i].first));
+			auto load = [&small_file](const string &contents, const text_format &f, unsigned threads) {
+				ofstream(small_file, ios::binary | ios::trunc) << contents;
+				tuple_vector<K, double> lv;
+				load_text(lv, small_file, f, threads);
+				return lv;
+			};
+			auto rejected = [&load](const string &contents, const text_format &f, unsigned threads) {
+				try {
+					load(contents, f, threads);
+				} catch (const runtime_error &) {
+					return true;
+				}
+				return false;
+			};
+			text_format comma;
+			comma.delimiter = ',';
+			for (unsigned threads : { 1u, 4u }) {
+				for (const auto &lv : { load(c[0] + "\t1.5\r\n" + c[1] + "\t2.5\r\n\r\n" + c[2] + "\t3.5\r\n", text_format(), threads),
+						load(c[0] + ",1.5\n" + c[1] + ",2.5\n" + c[2] + ",3.5\n", comma, threads),
+						load(c[0] + "\t1.5\n" + c[1] + "\t2.5\n" + c[2] + "\t3.5", text_format(), threads) })
+					if (lv.size() != 3 || lv.front().first != ts[0].first || lv.back().first != ts[2].first
+							|| lv.front().second != 1.5 || (lv.begin() + 1)->second != 2.5 || lv.back().second != 3.5)
+						abort();
+				if (!rejected(c[0] + "\t1.5\n" + c[1] + "\tabc\n", text_format(), threads)
+						|| !rejected(c[0] + "\t1.5\n" + c[1] + "\t2.5\rgarbage\n", text_format(), threads)
+						|| !rejected(c[0] + "\t1.5\rgarbage\n" + c[1] + "\t2.5\n", text_format(), threads)
+						|| !rejected(c[0] + "\t1.5\n" + c[1] + "\r\t2.5\n", text_format(), threads)
+						|| !rejected(c[0] + "\t1.5\n" + c[1] + "\n", text_format(), threads)
+						|| !rejected(c[0] + "\t1.5\n" + c[1] + "\t2.5\n", comma, threads)
+						|| !rejected(c[1] + "\t1.5\n" + c[0] + "\t2.5\n", text_format(), threads)
+						|| !rejected(c[0] + "\t1.5\n" + c[0] + "\t2.5\n", text_format(), threads))
+					abort();
+			}
+			// a truncated record and keys out of order in a binary file
+			{
+				ofstream bin(small_file, ios::binary | ios::trunc);
+				bin.write((const char *)&ts[1], sizeof(K) + sizeof(double) - 1);
+			}
+			bool truncated = false, unordered = false;
+			try {
+				tuple_vector<K, double> lv;
+				load_binary(lv, small_file);
+			} catch (const runtime_error &) {
+				truncated = true;
+			}
+			{
+				ofstream bin(small_file, ios::binary | ios::trunc);
+				for (size_t i : { 1, 0 }) {
+					bin.write((const char *)&ts[i].first, sizeof(K));
+					bin.write((const char *)&ts[i].second, sizeof(double));
+				}
+			}
+			try {
+				tuple_vector<K, double> lv;
+				load_binary(lv, small_file);
+			} catch (const runtime_error &) {
+				unordered = true;
+			}
+			if (!truncated || !unordered)
+				abort();
+			remove(small_file.c_str());
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "iostream",	[&text_file,&check]() {
+				tuple_vector<K, double> lv;
+				ifstream is(text_file);
+				string header;
+				getline(is, header);
+				long long code;
+				double v;
+				while (is >> code >> v)
+					lv.emplace_back(key_codec<K>::decode(code), v);
+				check(lv);
+			}},
+			{ "load_text 1 thread",	[&text_file,&fmt,&check]() {
+				tuple_vector<K, double> lv;
+				load_text(lv, text_file, fmt, 1);
+				check(lv);
+			}},
+			{ "load_text",	[&text_file,&fmt,&check]() {
+				tuple_vector<K, double> lv;
+				load_text(lv, text_file, fmt);
+				check(lv);
+			}},
+			{ "load_binary",	[&binary_file,&check]() {
+				tuple_vector<K, double> lv;
+				load_binary(lv, binary_file);
+				check(lv);
+			}}
+		});
+		remove(text_file.c_str());
+		remove(binary_file.c_str());
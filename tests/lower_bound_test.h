@@ -1,5 +1,18 @@
+		// keys just after every key of the series, in order and in random order
+		vector<K> keys, shuffled;
+		for (auto &i : ts) {
+			K dt = i.first;
+			dt++;
+			if (dt > ts.crbegin()->first)
+				break;
+			keys.push_back(dt);
+		}
+		shuffled = keys;
+		shuffle(shuffled.begin(), shuffled.end(), mt19937(keys.size()));
+		vector<size_t> idx(keys.size());
+
 		auto rt = cppbench::time(n_tests, {
-			{ "map",	[ts,map]() {
+			{ "map",	[&ts,&map]() {
 				K dt;
 				K l = ts.crbegin()->first;
 				for (auto &i : ts) {
@@ -14,7 +27,7 @@
 						abort();
 				}
 			}},
-			{ "tuple",	[ts,&tv]() {
+			{ "tuple",	[&ts,&tv]() {
 				K dt;
 				K l = ts.crbegin()->first;
 				for (auto &i : ts) {
@@ -28,5 +41,45 @@
 					if ((*it).first < dt)
 						abort();
 				}
+			}},
+			{ "tuple shuffled",	[&shuffled,&tv]() {
+				for (auto &k : shuffled) {
+					auto it = tv.lower_bound(k);
+					if (it == tv.end() || (*it).first < k)
+						abort();
+				}
+			}},
+			{ "tuple batch",	[&keys,&idx,&tv]() {
+				tv.lower_bound_many(keys.begin(), keys.end(), idx.begin());
+				for (size_t i = 0; i < keys.size(); i++)
+					if (idx[i] == tv.size() || tv[idx[i]].first < keys[i] || (idx[i] && !(tv[idx[i]-1].first < keys[i])))
+						abort();
+			}},
+			{ "tuple batch shuffled",	[&shuffled,&idx,&tv]() {
+				tv.lower_bound_many(shuffled.begin(), shuffled.end(), idx.begin());
+				for (size_t i = 0; i < shuffled.size(); i++)
+					if (idx[i] == tv.size() || tv[idx[i]].first < shuffled[i] || (idx[i] && !(tv[idx[i]-1].first < shuffled[i])))
+						abort();
+			}},
+			{ "columnar batch",	[&keys,&idx,&ctv]() {
+				ctv.lower_bound_many(keys.begin(), keys.end(), idx.begin());
+				for (size_t i = 0; i < keys.size(); i++)
+					if (idx[i] == ctv.size() || ctv[idx[i]].first < keys[i] || (idx[i] && !(ctv[idx[i]-1].first < keys[i])))
+						abort();
+			}},
+			{ "columnar",	[&ts,&ctv]() {
+				K dt;
+				K l = ts.crbegin()->first;
+				for (auto &i : ts) {
+					dt = i.first;
+					dt++;
+					if (dt > l)
+						break;
+					auto it = ctv.lower_bound(dt);
+					if (it == ctv.end())
+						abort();
+					if ((*it).first < dt)
+						abort();
+				}
 			}}
 		});
@@ -0,0 +1,124 @@
+		// find() on a memory-mapped file vs. the in-memory containers, plus the time it takes to
+		// map the file and run the first lookup, which is all a new process has to pay
+		const string path = "mapped_test.bin";
+		mapped_tuple_vector<K, double>::write(path, tv);
+		mapped_tuple_vector<K, double> mtv(path);
+		if (mtv.size() != tv.size())
+			abort();
+		{
+			// truncated and corrupt files must be rejected by open() instead of being searched
+			const string bad = "mapped_test_bad.bin";
+			vector<pair<K, double>> small;
+			K k = 0;
+			for (size_t i = 0; i < 1000; i++) {
+				small.emplace_back(k, 1.0);
+				// a gap every 10 elements, so the learned index has more than one segment
+				for (size_t j = 0; j < (i % 10 ? 1 : 100); j++)
+					k++;
+			}
+			mapped_tuple_vector<K, double>::write(bad, small, 4);
+			string good;
+			{
+				ifstream ifs(bad, ios::binary);
+				good.assign(istreambuf_iterator<char>(ifs), istreambuf_iterator<char>());
+			}
+			mapped_file_header h;
+			memcpy(&h, good.data(), sizeof(h));
+			if (!h.index_segments)
+				abort();
+			auto rejected = [&bad](const string &contents) {
+				ofstream(bad, ios::binary | ios::trunc).write(contents.data(), contents.size());
+				try {
+					mapped_tuple_vector<K, double> m(bad);
+				} catch (const runtime_error &) {
+					return true;
+				}
+				return false;
+			};
+			auto patched = [&good](size_t offset, uint64_t val) {
+				string s = good;
+				memcpy(&s[offset], &val, sizeof(val));
+				return s;
+			};
+			if (rejected(good))
+				abort();
+			if (!rejected(good.substr(0, sizeof(h) - 1)) || !rejected(good.substr(0, h.value_offset + 8)))
+				abort();
+			// count * sizeof(K) and index_segments * 24 wrap around to 0
+			if (!rejected(patched(offsetof(mapped_file_header, count), (uint64_t)1 << 61)))
+				abort();
+			if (!rejected(patched(offsetof(mapped_file_header, key_offset), h.key_offset + 1)))
+				abort();
+			if (!rejected(patched(offsetof(mapped_file_header, index_segments), (uint64_t)1 << 61)))
+				abort();
+			// segment index past the end of the key column
+			if (!rejected(patched(h.index_offset + 16, h.count + 1)))
+				abort();
+			// size() follows open() and close()
+			{
+				ofstream(bad, ios::binary | ios::trunc).write(good.data(), good.size());
+				mapped_tuple_vector<K, double> m(bad);
+				if (m.size() != small.size() || m.empty())
+					abort();
+				m.close();
+				if (m.size() != 0 || !m.empty() || m.begin() != m.end())
+					abort();
+			}
+			// a mapping can be returned from a function and moved around, keeping its learned index
+			{
+				ofstream(bad, ios::binary | ios::trunc).write(good.data(), good.size());
+				auto open_mapped = [&bad]() { return mapped_tuple_vector<K, double>(bad); };
+				mapped_tuple_vector<K, double> m = open_mapped(), moved(std::move(m)), assigned;
+				assigned = std::move(moved);
+				if (!m.empty() || !moved.empty() || m.index_segments() != 0 || moved.begin() != moved.end())
+					abort();
+				if (assigned.size() != small.size() || assigned.index_segments() != h.index_segments)
+					abort();
+				for (size_t i = 0; i < small.size(); i++)
+					if (assigned.find(small[i].first) != assigned.begin() + i)
+						abort();
+			}
+			// an epsilon which does not fit into the header is rejected
+			if (sizeof(size_t) > sizeof(uint32_t)) {
+				bool thrown = false;
+				try {
+					mapped_tuple_vector<K, double>::write(bad, small, (size_t)numeric_limits<uint32_t>::max() + 1);
+				} catch (const invalid_argument &) {
+					thrown = true;
+				}
+				if (!thrown)
+					abort();
+			}
+			remove(bad.c_str());
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "tuple",	[&shuffled,&tv]() {
+				for (auto &k : shuffled) {
+					auto it = tv.find(k);
+					if (it == tv.end() || (*it).first != k)
+						abort();
+				}
+			}},
+			{ "columnar",	[&shuffled,&ctv]() {
+				for (auto &k : shuffled) {
+					auto it = ctv.find(k);
+					if (it == ctv.end() || it->first != k)
+						abort();
+				}
+			}},
+			{ "mapped",	[&shuffled,&mtv]() {
+				for (auto &k : shuffled) {
+					auto it = mtv.find(k);
+					if (it == mtv.end() || it->first != k)
+						abort();
+				}
+			}},
+			{ "mapped open",	[&path,&shuffled]() {
+				mapped_tuple_vector<K, double> m(path);
+				if (m.find(shuffled.front()) == m.end())
+					abort();
+			}}
+		});
+		mtv.close();
+		remove(path.c_str());
@@ -0,0 +1,134 @@
+		// several ticks per timestamp: 1 to 3 elements for each key of the first half of ts,
+		// built and searched with equal_range() in a std::multimap and a multi_tuple_vector
+		vector<pair<K, double>> ticks;
+		vector<K> run_keys;
+		for (size_t i = 0; i < ts.size() / 2; i++) {
+			run_keys.push_back(ts[i].first);
+			for (size_t j = 0; j <= i % 3; j++)
+				ticks.emplace_back(ts[i].first, ts[i].second + j);
+		}
+		shuffle(run_keys.begin(), run_keys.end(), mt19937(run_keys.size()));
+		multimap<K, double> mmap;
+		multi_tuple_vector<K, double> mtv;
+
+		// every lookup has to return the front of its run: mixed runs with absent keys between them,
+		// one key only and runs with far more elements than the keys they span, built by appending
+		// and at once, with and without the learned index and the aggregate index
+		{
+			auto verify = [&ts](const vector<pair<K, double>> &ref, size_t n_keys) {
+				auto less = [](const pair<K, double> &a, const K &b) { return a.first < b; };
+				auto greater = [](const K &a, const pair<K, double> &b) { return a < b.first; };
+				vector<K> keys;
+				vector<size_t> lbs, finds;
+				for (size_t i = 0; i < n_keys; i++) {
+					keys.push_back(ts[i].first);
+					size_t lb = std::lower_bound(ref.begin(), ref.end(), ts[i].first, less) - ref.begin();
+					lbs.push_back(lb);
+					finds.push_back(lb < ref.size() && ref[lb].first == ts[i].first ? lb : ref.size());
+				}
+				multi_tuple_vector<K, double> appended, built(ref.begin(), ref.end()), indexed(ref.begin(), ref.end());
+				for (const auto &e : ref)
+					appended.emplace_back(e);
+				indexed.build_index(4);
+				for (auto *m : { &appended, &built, &indexed }) {
+					for (int pass = 0; pass < 2; pass++, m->build_aggregates()) {
+						for (size_t i = 0; i < keys.size(); i++) {
+							const K &k = keys[i];
+							size_t lb = m->lower_bound(k) - m->begin(), f = m->find(k) - m->begin();
+							size_t ub = m->upper_bound(k) - m->begin();
+							if (lb != lbs[i] || f != finds[i])
+								abort();
+							if (ub != (size_t)(std::upper_bound(ref.begin(), ref.end(), k, greater) - ref.begin()))
+								abort();
+							// the front of the run: its predecessor has a strictly smaller key
+							if (lb > 0 && lb < ref.size() && !(m->begin()[lb - 1].first < m->begin()[lb].first))
+								abort();
+						}
+						vector<size_t> many;
+						m->find_many(keys.begin(), keys.end(), back_inserter(many));
+						if (many != finds)
+							abort();
+						many.clear();
+						m->lower_bound_many(keys.begin(), keys.end(), back_inserter(many));
+						if (many != lbs)
+							abort();
+						// windows with both ends on the keys, i.e. often inside runs of duplicates
+						for (size_t a = 0; a < keys.size(); a += 13)
+							for (size_t d : { 0, 1, 2, 3, 17, 101 }) {
+								size_t b = min(a + d, keys.size() - 1);
+								auto w = m->aggregate(keys[a], keys[b]);
+								size_t cnt = 0;
+								double sum = 0, mn = numeric_limits<double>::max(), mx = numeric_limits<double>::lowest();
+								for (size_t j = lbs[a]; j < lbs[b]; j++, cnt++) {
+									sum += ref[j].second;
+									mn = min(mn, ref[j].second);
+									mx = max(mx, ref[j].second);
+								}
+								if (w.count != cnt || w.sum != sum || (cnt && (w.min != mn || w.max != mx)))
+									abort();
+							}
+					}
+				}
+			};
+			vector<pair<K, double>> ref;
+			double v = 0;
+			// 1 to 3 elements per key, every 5th key absent, every 97th key with 300 elements
+			for (size_t i = 5; i < 2005; i++)
+				if (i % 5 != 0)
+					for (size_t j = 0; j < (i % 97 == 0 ? 300 : i % 3 + 1); j++)
+						ref.emplace_back(ts[i].first, v++);
+			verify(ref, 2010);
+			// a single key, so the keys span no range at all
+			ref.clear();
+			for (size_t j = 0; j < 500; j++)
+				ref.emplace_back(ts[10].first, v++);
+			verify(ref, 20);
+			// a few thousand elements on each of a handful of neighbouring keys
+			ref.clear();
+			for (size_t i : { 10, 11, 13, 14 })
+				for (size_t j = 0; j < 3000; j++)
+					ref.emplace_back(ts[i].first, v++);
+			verify(ref, 20);
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "multimap emplace",	[&ticks,&mmap]() {
+				mmap.clear();
+				for (auto &i : ticks)
+					mmap.emplace_hint(mmap.end(), i.first, i.second);
+			}},
+			{ "multi emplace",	[&ticks,&mtv]() {
+				mtv.clear();
+				for (auto &i : ticks)
+					mtv.emplace_back(i.first, i.second);
+			}},
+			{ "multimap equal_range",	[&run_keys,&mmap]() {
+				size_t n = 0;
+				for (auto &k : run_keys) {
+					auto r = mmap.equal_range(k);
+					if (r.first == r.second || r.first->first != k)
+						abort();
+					n += distance(r.first, r.second);
+				}
+				if (n != mmap.size())
+					abort();
+			}},
+			{ "multi equal_range",	[&run_keys,&mtv]() {
+				size_t n = 0;
+				for (auto &k : run_keys) {
+					auto r = mtv.equal_range(k);
+					if (r.first == r.second || r.first->first != k)
+						abort();
+					n += r.second - r.first;
+				}
+				if (n != mtv.size())
+					abort();
+			}},
+			{ "multi count",	[&run_keys,&mtv]() {
+				size_t n = 0;
+				for (auto &k : run_keys)
+					n += mtv.count(k);
+				if (n != mtv.size())
+					abort();
+			}}
+		});
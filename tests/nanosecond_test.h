@@ -0,0 +1,83 @@
+		// nanosecond epoch timestamps about 1us apart with some jitter, looked up in random order,
+		// as std::chrono keys (exact integer interpolation) and as the same values in doubles, both
+		// with lookup statistics so that the resync distances of the two can be compared
+		typedef chrono::time_point<chrono::system_clock, chrono::nanoseconds> ns_time;
+		mt19937_64 rng(ts.size());
+		tuple_vector<ns_time, double, search_stats> nstv;
+		columnar_tuple_vector<ns_time, double> nsctv;
+		tuple_vector<double, double, search_stats> dtv;
+		std::map<ns_time, double> nsmap;
+		vector<ns_time> nskeys;
+		ns_time t(chrono::nanoseconds(1700000000000000000LL));
+		for (size_t n = 0; n < ts.size(); n++) {
+			t += chrono::nanoseconds(900 + rng() % 200);
+			nskeys.push_back(t);
+			nstv.emplace_back(t, 3.1415926);
+			nsctv.emplace_back(t, 3.1415926);
+			dtv.emplace_back((double)t.time_since_epoch().count(), 3.1415926);
+			nsmap.emplace(t, 3.1415926);
+		}
+		shuffle(nskeys.begin(), nskeys.end(), rng);
+
+		// the exact integer guesses never land further away from the sought key than the double ones
+		for (auto &k : nskeys) {
+			if (nstv.find(k) == nstv.end())
+				abort();
+			if (dtv.find((double)k.time_since_epoch().count()) == dtv.end())
+				abort();
+		}
+		if (nstv.stats().resync_quantile(0.99) > dtv.stats().resync_quantile(0.99)
+				|| nstv.stats().resync_quantile(0.5) > dtv.stats().resync_quantile(0.5))
+			abort();
+		// without jitter the exact guess is right almost every time, while the doubles, which
+		// cannot hold the low bits of the timestamps, miss about every other key
+		{
+			tuple_vector<ns_time, double, search_stats> even;
+			tuple_vector<double, double, search_stats> deven;
+			ns_time e(chrono::nanoseconds(1700000000000000000LL));
+			for (size_t n = 0; n < ts.size(); n++) {
+				e += chrono::nanoseconds(1000);
+				even.emplace_back(e, 3.1415926);
+				deven.emplace_back((double)e.time_since_epoch().count(), 3.1415926);
+			}
+			for (size_t i = 0; i < ts.size(); i++) {
+				const size_t n = rng() % ts.size();
+				if (even.find(even[n].first) != even.begin() + n)
+					abort();
+				if (deven.find(deven[n].first) != deven.begin() + n)
+					abort();
+			}
+			if (even.stats().hits <= deven.stats().hits
+					|| even.stats().resync_quantile(0.99) > deven.stats().resync_quantile(0.99))
+				abort();
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "map",	[&nskeys,&nsmap]() {
+				for (auto &k : nskeys)
+					if (nsmap.find(k) == nsmap.end())
+						abort();
+			}},
+			{ "tuple",	[&nskeys,&nstv]() {
+				for (auto &k : nskeys) {
+					auto it = nstv.find(k);
+					if (it == nstv.end() || it->first != k)
+						abort();
+				}
+			}},
+			{ "columnar",	[&nskeys,&nsctv]() {
+				for (auto &k : nskeys) {
+					auto it = nsctv.find(k);
+					if (it == nsctv.end() || (*it).first != k)
+						abort();
+				}
+			}},
+			{ "tuple double",	[&nskeys,&dtv]() {
+				for (auto &k : nskeys) {
+					const double d = (double)k.time_since_epoch().count();
+					auto it = dtv.find(d);
+					if (it == dtv.end() || it->first != d)
+						abort();
+				}
+			}}
+		});
@@ -0,0 +1,31 @@
+		// random find() in a tuple_vector and in the local replica of a numa_tuple_vector,
+		// by one thread per NUMA node pinned to it (a single replica on single node machines)
+		numa_tuple_vector<K, double> nv;
+		nv.reserve(ts.size());
+		for (const auto &i : ts)
+			nv.emplace_back(i);
+		const vector<int> nodes = numa_nodes();
+
+		auto pinned_find = [&shuffled,&nodes](auto found) {
+			return [&shuffled,&nodes,found]() {
+				vector<thread> threads;
+				for (size_t t = 0; t < nodes.size(); t++)
+					threads.emplace_back([&shuffled,&nodes,&found,t]() {
+						numa_pin_thread(nodes[t]);
+						search_context ctx;
+						for (size_t i = t; i < shuffled.size(); i += nodes.size())
+							if (!found(shuffled[i], ctx))
+								abort();
+					});
+				for (auto &t : threads)
+					t.join();
+			};
+		};
+
+		auto rt = cppbench::time(n_tests, {
+			{ "tuple",	pinned_find([&tv](const K &k, search_context &ctx) { return tv.find(k, ctx) != tv.end(); }) },
+			{ "numa",	pinned_find([&nv](const K &k, search_context &ctx) {
+				const auto &r = nv.local();
+				return r.find(k, ctx) != r.end();
+			}) }
+		});
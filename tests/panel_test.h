@@ -0,0 +1,97 @@
+		// bid, ask and size per timestamp: three tuple_vectors searched once each vs. one panel
+		tuple_vector<K, double> bid, ask;
+		tuple_vector<K, int> size;
+		tuple_panel<K, double, double, int> panel;
+		panel.reserve(ts.size());
+		int n = 0;
+		for (const auto &i : ts) {
+			bid.emplace_back(i.first, i.second);
+			ask.emplace_back(i.first, i.second + 0.5);
+			size.emplace_back(i.first, n % 100);
+			panel.emplace_back(i.first, i.second, i.second + 0.5, n++ % 100);
+		}
+
+		// a value constructor which throws must not leave any column longer than the others
+		{
+			struct failing {
+				operator double() const { throw invalid_argument("no value"); }
+			};
+			tuple_panel<K, double, double, int> p;
+			for (size_t i = 0; i < 1000; i++) {
+				// throw in the second column right when the columns have to grow
+				if (p.size() == p.capacity()) {
+					try {
+						p.emplace_back(ts[i].first, ts[i].second, failing(), 1);
+						abort();
+					} catch (const invalid_argument &) {
+					}
+					if (p.size() != i || p.template column<0>().size() != i || p.template column<1>().size() != i
+							|| p.template column<2>().size() != i)
+						abort();
+					if (i && p.find(ts[i - 1].first) != p.end() - 1)
+						abort();
+				}
+				p.emplace_back(ts[i].first, ts[i].second, ts[i].second + 0.5, (int)i);
+			}
+			for (size_t i = 0; i < 1000; i++) {
+				auto it = p.find(ts[i].first);
+				if (it == p.end() || it.key() != ts[i].first || it.template get<0>() != ts[i].second
+						|| it.template get<2>() != (int)i)
+					abort();
+			}
+		}
+
+		// assignment keeps the learned index, just like copy construction
+		{
+			tuple_panel<K, double, double, int> src, copied, moved;
+			for (size_t i = 0; i < 10000 && i < ts.size(); i++)
+				src.emplace_back(ts[i].first, ts[i].second, ts[i].second + 0.5, (int)i);
+			src.build_index();
+			copied = src;
+			tuple_panel<K, double, double, int> tmp(src);
+			moved = std::move(tmp);
+			for (const auto *c : { &copied, &moved }) {
+				if (c->index_segments() != src.index_segments() || c->size() != src.size())
+					abort();
+				for (size_t i = 0; i < src.size(); i += 97)
+					if (c->find(ts[i].first) != c->begin() + i)
+						abort();
+			}
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "3 tuples",	[&shuffled,&bid,&ask,&size]() {
+				double spread = 0;
+				for (auto &k : shuffled) {
+					auto b = bid.find(k);
+					auto a = ask.find(k);
+					auto s = size.find(k);
+					if (b == bid.end() || a == ask.end() || s == size.end() || b->first != k)
+						abort();
+					spread += (a->second - b->second) * s->second;
+				}
+				if (spread <= 0)
+					abort();
+			}},
+			{ "panel",	[&shuffled,&panel]() {
+				double spread = 0;
+				for (auto &k : shuffled) {
+					auto it = panel.find(k);
+					if (it == panel.end() || it.key() != k)
+						abort();
+					spread += (it.template get<1>() - it.template get<0>()) * it.template get<2>();
+				}
+				if (spread <= 0)
+					abort();
+			}},
+			{ "panel column scan",	[&panel]() {
+				// column-wise loop over two of the three value columns
+				const auto &b = panel.template column<0>();
+				const auto &a = panel.template column<1>();
+				double spread = 0;
+				for (size_t i = 0; i < panel.size(); i++)
+					spread += a[i] - b[i];
+				if (spread <= 0)
+					abort();
+			}}
+		});
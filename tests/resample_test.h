@@ -0,0 +1,69 @@
+		// OHLC bars and last values of buckets of 60 elements, by a lower_bound() per bucket plus a
+		// walk over the bucket and by resample_ohlc() / resample_last()
+		const size_t per_bucket = 60;
+		fixed_buckets<K> bucket(key<K>()(ts[per_bucket].first) - key<K>()(ts[0].first), key<K>()(ts[0].first));
+		vector<pair<int64_t, ohlc<double>>> bars;
+		vector<pair<int64_t, double>> last;
+
+		// the keys of ts with random values, so high and low differ from open and close
+		tuple_vector<K, double> rtv;
+		{
+			mt19937 gen(ts.size());
+			uniform_real_distribution<double> price(90.0, 110.0);
+			for (auto &i : ts)
+				rtv.emplace_back(i.first, price(gen));
+		}
+		// reference bars, built element by element from the bucket of every key - the buckets are
+		// key-based, so with gaps in the keys they hold fewer than per_bucket elements and empty
+		// buckets are left out
+		vector<pair<int64_t, ohlc<double>>> ref;
+		for (auto &i : rtv) {
+			int64_t label = bucket(i.first);
+			if (ref.empty() || ref.back().first != label)
+				ref.emplace_back(label, ohlc<double>{i.second, i.second, i.second, i.second, 0});
+			ohlc<double> &bar = ref.back().second;
+			bar.high = max(bar.high, i.second);
+			bar.low = min(bar.low, i.second);
+			bar.close = i.second;
+			bar.count++;
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "lower_bound loop",	[&ts,&rtv,&bars,per_bucket]() {
+				bars.clear();
+				for (size_t b = 0; b < ts.size(); b += per_bucket) {
+					auto first = rtv.lower_bound(ts[b].first);
+					auto last = b + per_bucket < ts.size() ? rtv.lower_bound(ts[b + per_bucket].first) : rtv.end();
+					ohlc<double> bar{first->second, first->second, first->second, first->second, 0};
+					for (; first != last; ++first, ++bar.count) {
+						bar.high = max(bar.high, first->second);
+						bar.low = min(bar.low, first->second);
+						bar.close = first->second;
+					}
+					bars.emplace_back(b / per_bucket, bar);
+				}
+				if (bars.size() != (ts.size() + per_bucket - 1) / per_bucket || bars[0].second.count != per_bucket)
+					abort();
+			}},
+			{ "resample_ohlc",	[&ref,&rtv,&bars,&bucket]() {
+				bars.clear();
+				resample_ohlc(rtv, bucket, bars);
+				if (bars.size() != ref.size())
+					abort();
+				for (size_t b = 0; b < ref.size(); b++) {
+					const ohlc<double> &x = bars[b].second, &y = ref[b].second;
+					if (bars[b].first != ref[b].first || x.open != y.open || x.high != y.high || x.low != y.low
+							|| x.close != y.close || x.count != y.count)
+						abort();
+				}
+			}},
+			{ "resample_last",	[&ref,&rtv,&last,&bucket]() {
+				last.clear();
+				resample_last(rtv, bucket, last);
+				if (last.size() != ref.size())
+					abort();
+				for (size_t b = 0; b < ref.size(); b++)
+					if (last[b].first != ref[b].first || last[b].second != ref[b].second.close)
+						abort();
+			}}
+		});
@@ -0,0 +1,58 @@
+		// sparse timeseries with random gaps so that find() and lower_bound() need long resync scans,
+		// the results are cross-checked against std::lower_bound for randomly chosen keys
+		vector<pair<K, double>> sts;
+		vector<K> queries;
+		vector<size_t> expected;
+		{
+			mt19937 rng(ts.size());
+			K dt = 0;
+			for (size_t n = 0; n < ts.size(); n++, dt++) {
+				sts.emplace_back(dt, n);
+				for (size_t gap = rng() % 8 ? 0 : rng() % 64; gap; --gap)
+					dt++;
+			}
+			for (size_t n = 0; n < ts.size(); n++) {
+				K q = sts[rng() % sts.size()].first;
+				if (rng() % 2)
+					q++;
+				queries.push_back(q);
+				expected.push_back(std::lower_bound(sts.begin(), sts.end(), q,
+					[](const pair<K, double> &a, const K &b) { return a.first < b; }) - sts.begin());
+			}
+		}
+		tuple_vector<K, double> stv;
+		columnar_tuple_vector<K, double> sctv;
+		stv.assign(sts.begin(), sts.end());
+		for (const auto &it : sts)
+			sctv.emplace_back(it);
+
+		auto rt = cppbench::time(n_tests, {
+			{ "vector",	[&sts,&queries]() {
+				for (auto &q : queries) {
+					auto it = std::lower_bound(sts.begin(), sts.end(), q,
+						[](const pair<K, double> &a, const K &b) { return a.first < b; });
+					if (it != sts.end() && it->first < q)
+						abort();
+				}
+			}},
+			{ "tuple",	[&sts,&stv,&queries,&expected]() {
+				for (size_t i = 0; i < queries.size(); i++) {
+					auto it = stv.lower_bound(queries[i]);
+					if (size_t(it - stv.begin()) != expected[i])
+						abort();
+					bool found = expected[i] < sts.size() && sts[expected[i]].first == queries[i];
+					if (size_t(stv.find(queries[i]) - stv.begin()) != (found ? expected[i] : sts.size()))
+						abort();
+				}
+			}},
+			{ "columnar",	[&sts,&sctv,&queries,&expected]() {
+				for (size_t i = 0; i < queries.size(); i++) {
+					auto it = sctv.lower_bound(queries[i]);
+					if (size_t(it - sctv.begin()) != expected[i])
+						abort();
+					bool found = expected[i] < sts.size() && sts[expected[i]].first == queries[i];
+					if (size_t(sctv.find(queries[i]) - sctv.begin()) != (found ? expected[i] : sts.size()))
+						abort();
+				}
+			}}
+		});
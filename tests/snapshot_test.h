@@ -0,0 +1,123 @@
+		// one writer appends the second half of ts while reader threads look up the first half:
+		// readers and writer share a mutex in the "mutex" entry, the readers of the "snapshot"
+		// entry take a snapshot every 256 lookups and never block the writer
+		const size_t n_readers = 3, batch = 256;
+		const size_t half = ts.size() / 2;
+
+		// a buffer retired while a reader still holds a snapshot of it is kept until the reader is
+		// gone, and the snapshot keeps seeing its elements
+		{
+			snapshot_tuple_vector<K, double> stv(16);
+			for (size_t i = 0; i < 16; i++)
+				stv.emplace_back(ts[i]);
+			{
+				typename snapshot_tuple_vector<K, double>::reader r(stv);
+				auto snap = r.snapshot();
+				for (size_t i = 16; i < 1000; i++)
+					stv.emplace_back(ts[i]);
+				stv.reclaim();
+				if (stv.retired() == 0 || snap.size() != 16)
+					abort();
+				for (size_t i = 0; i < 16; i++)
+					if (snap.find(ts[i].first) != snap.begin() + i || snap[i].second != ts[i].second)
+						abort();
+			}
+			stv.reclaim();
+			if (stv.retired() != 0 || stv.size() != 1000)
+				abort();
+		}
+
+		// readers see a growing series while the buffer is replaced over and over: the size of
+		// successive snapshots never goes down, and every key below it is found at its index
+		{
+			snapshot_tuple_vector<K, double> stv(1024);
+			for (size_t i = 0; i < 1000; i++)
+				stv.emplace_back(ts[i]);
+			atomic<bool> done(false);
+			vector<thread> threads;
+			for (size_t t = 0; t < n_readers; t++)
+				threads.emplace_back([&ts,&stv,&done,batch,t]() {
+					typename snapshot_tuple_vector<K, double>::reader r(stv);
+					size_t last = 0, next = t * batch;
+					for (bool more = true; more; ) {
+						more = !done.load();
+						auto snap = r.snapshot();
+						const size_t n = snap.size();
+						if (n < last)
+							abort();
+						last = n;
+						// a window of consecutive keys per snapshot, wrapping around, and all of
+						// them once the writer is done
+						size_t first = 0, count = n;
+						if (more) {
+							first = next < n ? next : 0;
+							count = min(batch, n - first);
+							next = first + count;
+						}
+						for (size_t i = first; i < first + count; i++)
+							if (snap.find(ts[i].first) != snap.begin() + i)
+								abort();
+						// nothing appended after the snapshot was taken is visible
+						if (n < ts.size() && snap.find(ts[n].first) != snap.end())
+							abort();
+						if (!more && n != ts.size())
+							abort();
+					}
+				});
+			for (size_t i = 1000; i < ts.size(); i++)
+				stv.emplace_back(ts[i]);
+			done = true;
+			for (auto &t : threads)
+				t.join();
+			stv.reclaim();
+			if (stv.retired() != 0 || stv.size() != ts.size())
+				abort();
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "mutex",	[&ts,half,n_readers]() {
+				tuple_vector<K, double> tv;
+				tv.assign(ts.cbegin(), ts.cbegin() + half);
+				mutex mtx;
+				vector<thread> threads;
+				for (size_t t = 0; t < n_readers; t++)
+					threads.emplace_back([&ts,&tv,&mtx,half,t]() {
+						search_context ctx;
+						for (size_t i = t; i < half; i += 3) {
+							lock_guard<mutex> guard(mtx);
+							if (tv.find(ts[i].first, ctx) == tv.end())
+								abort();
+						}
+					});
+				for (size_t i = half; i < ts.size(); i++) {
+					lock_guard<mutex> guard(mtx);
+					tv.emplace_back(ts[i]);
+				}
+				for (auto &t : threads)
+					t.join();
+				if (tv.size() != ts.size())
+					abort();
+			}},
+			{ "snapshot",	[&ts,half,n_readers,batch]() {
+				snapshot_tuple_vector<K, double> stv(half);
+				for (size_t i = 0; i < half; i++)
+					stv.emplace_back(ts[i]);
+				vector<thread> threads;
+				for (size_t t = 0; t < n_readers; t++)
+					threads.emplace_back([&ts,&stv,half,batch,t]() {
+						typename snapshot_tuple_vector<K, double>::reader r(stv);
+						for (size_t i = t; i < half; ) {
+							auto snap = r.snapshot();
+							for (size_t j = 0; j < batch && i < half; j++, i += 3)
+								if (snap.find(ts[i].first) == snap.end())
+									abort();
+						}
+					});
+				for (size_t i = half; i < ts.size(); i++)
+					stv.emplace_back(ts[i]);
+				for (auto &t : threads)
+					t.join();
+				if (stv.size() != ts.size())
+					abort();
+			}}
+		});
@@ -0,0 +1,52 @@
+		// find() in random order without and with lookup statistics
+		tuple_vector<K, double, search_stats> stv;
+		stv.assign(tv.cbegin(), tv.cend());
+
+		// without any resyncs all quantiles are 0
+		if (search_stats_snapshot().resync_quantile(0.5) != 0 || search_stats_snapshot().resync_quantile(0.99) != 0)
+			abort();
+
+		auto rt = cppbench::time(n_tests, {
+			{ "tuple",	[&shuffled,&tv]() {
+				for (auto &k : shuffled) {
+					auto it = tv.find(k);
+					if (it == tv.end() || it->first != k)
+						abort();
+				}
+			}},
+			{ "tuple stats",	[&shuffled,&stv]() {
+				for (auto &k : shuffled) {
+					auto it = stv.find(k);
+					if (it == stv.end() || it->first != k)
+						abort();
+				}
+			}}
+		});
+		// every find() is counted once, either as a hit or as a resync of some distance
+		stv.reset();
+		for (auto &k : shuffled)
+			if (stv.find(k) == stv.end())
+				abort();
+		search_stats_snapshot st = stv.stats();
+		uint64_t bucketed = 0;
+		for (int b = 0; b < TUPLE_VECTOR_STATS_BUCKETS; b++)
+			bucketed += st.forward[b] + st.backward[b];
+		if (st.lookups() != shuffled.size() || bucketed != st.resyncs)
+			abort();
+
+		// a lower_bound() whose initial guess is right is a hit, not a resync of distance 0
+		{
+			tuple_vector<K, double, search_stats> uv;
+			K dt = 0;
+			for (size_t n = 0; n < 10000; n++, dt++)
+				uv.emplace_back(dt, (double)n);
+			for (const auto &e : uv)
+				if (uv.lower_bound(e.first)->first != e.first)
+					abort();
+			if (uv.stats().hits != uv.size() || uv.stats().resyncs != 0)
+				abort();
+		}
+
+		// no_search_stats records nothing
+		if (tuple_vector<K, double>().stats().lookups() != 0 || tv.stats().lookups() != 0 || tv.stats().outofbound() != 0)
+			abort();
@@ -0,0 +1,95 @@
+		// count, sum, min and max over time windows of 10 up to 1M elements starting at random keys,
+		// once by walking the window after a lower_bound() and once with the aggregate index
+		tuple_vector<K, double> wtv, atv;
+		{
+			mt19937 rng(ts.size());
+			for (const auto &i : ts)
+				wtv.emplace_back(i.first, (double)(rng() % 1000));
+			atv = wtv;
+			atv.build_aggregates();
+		}
+		cout << "aggregate index: " << atv.aggregate_bytes() << " bytes" << endl;
+		// window [ts[s], ts[s + w]) holds exactly w elements
+		auto windows = [&ts](size_t w) {
+			vector<size_t> starts;
+			mt19937 rng(w);
+			w = min(w, ts.size() - 1);
+			for (size_t n = 0; n < 100; n++)
+				starts.push_back(rng() % (ts.size() - w));
+			return make_pair(w, starts);
+		};
+		auto walk = [&ts,&wtv,&windows](size_t w) {
+			auto ws = windows(w);
+			return [&ts,&wtv,ws]() {
+				for (size_t s : ws.second) {
+					const K &t1 = ts[s + ws.first].first;
+					double sum = 0, mn = numeric_limits<double>::max(), mx = numeric_limits<double>::lowest();
+					size_t cnt = 0;
+					for (auto it = wtv.lower_bound(ts[s].first); it != wtv.end() && it->first < t1; ++it, ++cnt) {
+						sum += it->second;
+						mn = min(mn, it->second);
+						mx = max(mx, it->second);
+					}
+					if (cnt != ws.first || mn > mx || sum < 0)
+						abort();
+				}
+			};
+		};
+		auto index = [&ts,&atv,&windows](size_t w) {
+			auto ws = windows(w);
+			return [&ts,&atv,ws]() {
+				for (size_t s : ws.second) {
+					auto a = atv.aggregate(ts[s].first, ts[s + ws.first].first);
+					if (a.count != ws.first || a.min > a.max || a.sum < 0)
+						abort();
+				}
+			};
+		};
+		// both ways must agree
+		for (size_t w : { 10, 1000, 100000, 1000000 }) {
+			auto ws = windows(w);
+			for (size_t s : ws.second) {
+				auto a = atv.aggregate(ts[s].first, ts[s + ws.first].first);
+				auto b = wtv.aggregate(ts[s].first, ts[s + ws.first].first);
+				if (a.count != b.count || a.sum != b.sum || a.min != b.min || a.max != b.max)
+					abort();
+			}
+		}
+
+		// assignment keeps the learned index and the aggregate index, just like copy construction -
+		// they are copied without their spare capacity, so only their contents are compared
+		{
+			columnar_tuple_vector<K, double> src, copied, moved;
+			for (size_t n = 0; n < 10000; n++)
+				src.emplace_back(wtv[n].first, wtv[n].second);
+			src.build_index();
+			src.build_aggregates();
+			copied = src;
+			columnar_tuple_vector<K, double> tmp(src);
+			moved = std::move(tmp);
+			for (const auto *c : { &copied, &moved }) {
+				if (c->index_segments() != src.index_segments() || c->aggregate_bytes() == 0)
+					abort();
+				auto a = c->aggregate(ts[10].first, ts[9000].first), b = src.aggregate(ts[10].first, ts[9000].first);
+				if (a.count != b.count || a.sum != b.sum || a.min != b.min || a.max != b.max)
+					abort();
+			}
+			tuple_vector<K, double> tsrc(wtv.begin(), wtv.begin() + 10000), tcopied;
+			tsrc.build_index();
+			tsrc.build_aggregates();
+			tcopied = tsrc;
+			if (tcopied.index_segments() != tsrc.index_segments() || tcopied.aggregate_bytes() == 0
+					|| tcopied.aggregate(ts[10].first, ts[9000].first).sum != tsrc.aggregate(ts[10].first, ts[9000].first).sum)
+				abort();
+		}
+
+		auto rt = cppbench::time(n_tests, {
+			{ "walk 10",		walk(10) },
+			{ "index 10",		index(10) },
+			{ "walk 1000",		walk(1000) },
+			{ "index 1000",		index(1000) },
+			{ "walk 100000",	walk(100000) },
+			{ "index 100000",	index(100000) },
+			{ "walk 1000000",	walk(1000000) },
+			{ "index 1000000",	index(1000000) }
+		});
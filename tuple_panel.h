@@ -0,0 +1,361 @@
+/**
+ * \file	tuple_panel.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __tuple_panel_h
+#define __tuple_panel_h
+
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "tuple_vector.h"
+
+template<typename Stats, typename K, typename... V>
+class basic_tuple_panel;
+
+/**
+ * \brief Random access iterator over the rows of a basic_tuple_panel. It only holds the panel
+ *		and a row index, key() and get<I>() read the key column and the I-th value column.
+ *		Dereferencing yields a std::tuple of references to the key and all values of the row,
+ *		select<I...>() one with the chosen value columns only.
+ * \tparam Panel the panel type, const for a const_iterator
+ */
+template<typename Panel>
+class panel_iterator {
+	typedef typename std::remove_const<Panel>::type panel_type;
+	static constexpr bool is_const = std::is_const<Panel>::value;
+
+	template<size_t I>
+	using column_value = typename std::conditional<is_const,
+		const typename panel_type::template value_type_of<I>,
+		typename panel_type::template value_type_of<I>>::type;
+
+public:
+	typedef std::random_access_iterator_tag									iterator_category;
+	typedef typename panel_type::value_type									value_type;
+	typedef std::ptrdiff_t													difference_type;
+	typedef typename std::conditional<is_const, typename panel_type::const_reference,
+		typename panel_type::reference>::type								reference;
+	typedef void															pointer;
+
+	panel_iterator() { }
+	panel_iterator(Panel *panel, size_t idx) : m_panel(panel), m_idx(idx) { }
+	/// allow conversion from iterator to const_iterator
+	template<typename P, typename = typename std::enable_if<std::is_same<const P, Panel>::value && !std::is_same<P, Panel>::value>::type>
+	panel_iterator(const panel_iterator<P> &it) : m_panel(it.panel()), m_idx(it.index()) { }
+
+	/// key of the row
+	inline const typename panel_type::key_type &key() const { return m_panel->keys()[m_idx]; }
+	/// value of the row in column I
+	template<size_t I>
+	inline column_value<I> &get() const { return m_panel->template _column<I>()[m_idx]; }
+	/// references to the values of the row in the columns I...
+	template<size_t... I>
+	inline std::tuple<column_value<I> &...> select() const { return std::tuple<column_value<I> &...>(get<I>()...); }
+
+	inline reference operator*() const { return (*m_panel)[m_idx]; }
+	inline reference operator[](difference_type n) const { return (*m_panel)[m_idx + n]; }
+
+	inline panel_iterator &operator++() { ++m_idx; return *this; }
+	inline panel_iterator &operator--() { --m_idx; return *this; }
+	inline panel_iterator operator++(int) { panel_iterator it(*this); ++m_idx; return it; }
+	inline panel_iterator operator--(int) { panel_iterator it(*this); --m_idx; return it; }
+	inline panel_iterator &operator+=(difference_type n) { m_idx += n; return *this; }
+	inline panel_iterator &operator-=(difference_type n) { m_idx -= n; return *this; }
+	inline panel_iterator operator+(difference_type n) const { return panel_iterator(m_panel, m_idx + n); }
+	inline panel_iterator operator-(difference_type n) const { return panel_iterator(m_panel, m_idx - n); }
+	inline difference_type operator-(const panel_iterator &it) const { return (difference_type)m_idx - (difference_type)it.m_idx; }
+
+	inline bool operator==(const panel_iterator &it) const { return m_idx == it.m_idx; }
+	inline bool operator!=(const panel_iterator &it) const { return m_idx != it.m_idx; }
+	inline bool operator<(const panel_iterator &it) const { return m_idx < it.m_idx; }
+	inline bool operator>(const panel_iterator &it) const { return m_idx > it.m_idx; }
+	inline bool operator<=(const panel_iterator &it) const { return m_idx <= it.m_idx; }
+	inline bool operator>=(const panel_iterator &it) const { return m_idx >= it.m_idx; }
+
+	inline Panel *panel() const { return m_panel; }
+	inline size_t index() const { return m_idx; }
+
+private:
+	Panel *m_panel = nullptr;
+	size_t m_idx = 0;
+};
+
+/**
+ * \brief Multi-column variant of columnar_tuple_vector: one strictly increasing key column and
+ *		one value column per type in V..., e.g. bid, ask and size of every timestamp. A single
+ *		find() or lower_bound() on the key column gives access to any subset of the value
+ *		columns through the returned iterator, instead of one search and one copy of the keys
+ *		per column as with several tuple_vectors. Every column is a contiguous std::vector, so
+ *		column-wise loops over column<I>() stay vectorisable.
+ *		Like tuple_vector, the container does not sort, so any data needs to be presorted.
+ * \tparam Stats lookup statistics policy, no_search_stats or search_stats
+ * \tparam K A datetime type, e.g. time_t, boost::posix_time::ptime or similar.
+ * \tparam V The value types of the columns.
+ */
+template<typename Stats, typename K, typename... V>
+class basic_tuple_panel : public interpolation_search<K, K, Stats> {
+	static_assert(sizeof...(V) > 0, "basic_tuple_panel needs at least one value column");
+	typedef interpolation_search<K, K, Stats> search_type;
+	typedef std::index_sequence_for<V...> columns;
+	using search_type::m_ctx;
+	template<typename P> friend class panel_iterator;
+public:
+	typedef K													key_type;
+	typedef std::tuple<K, V...>									value_type;
+	typedef std::tuple<const K &, V &...>						reference;
+	typedef std::tuple<const K &, const V &...>					const_reference;
+	typedef panel_iterator<basic_tuple_panel>					iterator;
+	typedef panel_iterator<const basic_tuple_panel>				const_iterator;
+	typedef typename std::vector<K>::size_type					size_type;
+	typedef typename search_type::context_type					context_type;
+	/// type of the values in column I
+	template<size_t I>
+	using value_type_of = typename std::tuple_element<I, std::tuple<V...>>::type;
+	/// number of value columns
+	static constexpr size_t column_count = sizeof...(V);
+
+	basic_tuple_panel() { }
+
+	basic_tuple_panel(size_type n) : m_keys(n), m_columns(std::vector<V>(n)...) { _refresh(); }
+
+	basic_tuple_panel(const basic_tuple_panel &x) : search_type(x), m_keys(x.m_keys), m_columns(x.m_columns) { _refresh(); }
+
+	basic_tuple_panel(basic_tuple_panel &&x) : search_type(x), m_keys(std::move(x.m_keys)), m_columns(std::move(x.m_columns)) {
+		_refresh();
+		x._refresh();
+	}
+
+	~basic_tuple_panel() { }
+
+	inline basic_tuple_panel &operator=(const basic_tuple_panel &x) {
+		m_keys = x.m_keys;
+		m_columns = x.m_columns;
+		search_type::operator=(x);
+		_refresh();
+		return *this;
+	}
+	inline basic_tuple_panel &operator=(basic_tuple_panel &&x) {
+		m_keys = std::move(x.m_keys);
+		m_columns = std::move(x.m_columns);
+		search_type::operator=(x);
+		_refresh();
+		x._refresh();
+		return *this;
+	}
+
+	// Capacity
+	inline size_type size() const noexcept { return m_keys.size(); }
+	inline bool empty() const noexcept { return m_keys.empty(); }
+	inline size_type capacity() const noexcept { return m_keys.capacity(); }
+	inline void reserve(size_type n) {
+		// value columns first: if reserving the keys throws, the searched key column is left untouched
+		_for_each_column([n](auto &c) { c.reserve(n); });
+		m_keys.reserve(n);
+		_refresh();
+	}
+
+	// Modifying operations.
+	void clear() noexcept {
+		m_keys.clear();
+		_for_each_column([](auto &c) { c.clear(); });
+		_refresh();
+	}
+	/// append a row, one value per column, if constructing a value throws the row is taken back before rethrowing
+	template <typename... Args> inline void emplace_back(const K &key, Args&&... values) {
+		static_assert(sizeof...(Args) == sizeof...(V), "emplace_back() needs one value per column");
+		m_keys.emplace_back(key);
+		try {
+			_emplace_back(columns(), std::forward<Args>(values)...);
+		} catch (...) {
+			// the columns before the one that threw already hold the new value
+			const size_type n = m_keys.size();
+			_for_each_column([n](auto &c) { if (c.size() == n) c.pop_back(); });
+			m_keys.pop_back();
+			// the key column may have been reallocated, so the search has to be pointed at it again
+			_refresh();
+			throw;
+		}
+		_append();
+	}
+	inline void push_back(const value_type &row) {
+		_push_back(row, columns());
+	}
+	inline void pop_back() {
+		m_keys.pop_back();
+		_for_each_column([](auto &c) { c.pop_back(); });
+		_refresh();
+	}
+	inline void resize(size_type n) {
+		m_keys.resize(n);
+		_for_each_column([n](auto &c) { c.resize(n); });
+		_refresh();
+	}
+	inline void shrink_to_fit() {
+		m_keys.shrink_to_fit();
+		_for_each_column([](auto &c) { c.shrink_to_fit(); });
+		_refresh();
+	}
+
+	// Iterators
+	inline iterator begin() noexcept { return iterator(this, 0); }
+	inline iterator end() noexcept { return iterator(this, size()); }
+	inline const_iterator begin() const noexcept { return const_iterator(this, 0); }
+	inline const_iterator end() const noexcept { return const_iterator(this, size()); }
+	inline const_iterator cbegin() const noexcept { return begin(); }
+	inline const_iterator cend() const noexcept { return end(); }
+
+	// Access operations
+	inline iterator at(const K &key) {
+		auto pos = find(key);
+		if (pos == end())
+			throw std::out_of_range("iterator basic_tuple_panel::at(const K &key)");
+		return pos;
+	}
+	inline const_iterator at(const K &key) const {
+		return at(key, m_ctx);
+	}
+	inline const_iterator at(const K &key, context_type &ctx) const {
+		auto pos = find(key, ctx);
+		if (pos == end())
+			throw std::out_of_range("const_iterator basic_tuple_panel::at(const K &key) const");
+		return pos;
+	}
+	inline const_reference operator[](size_t idx) const {
+		return _row<const_reference>(*this, idx, columns());
+	}
+	inline reference operator[](size_t idx) {
+		return _row<reference>(*this, idx, columns());
+	}
+	inline const_reference front() const { return (*this)[0]; }
+	inline reference front() { return (*this)[0]; }
+	inline const_reference back() const { return (*this)[size() - 1]; }
+	inline reference back() { return (*this)[size() - 1]; }
+	inline iterator lower_bound(const K &key) {
+		return begin() + (search_type::_lower_bound(key, m_ctx) - m_keys.data());
+	}
+	inline const_iterator lower_bound(const K &key) const {
+		return lower_bound(key, m_ctx);
+	}
+	/// lower_bound() using the given search context, safe to call from several threads at once
+	inline const_iterator lower_bound(const K &key, context_type &ctx) const {
+		return begin() + (search_type::_lower_bound(key, ctx) - m_keys.data());
+	}
+	inline iterator find(const K &key) {
+		return begin() + (search_type::_find(key, m_ctx) - m_keys.data());
+	}
+	inline const_iterator find(const K &key) const {
+		return find(key, m_ctx);
+	}
+	/// find() using the given search context, safe to call from several threads at once
+	inline const_iterator find(const K &key, context_type &ctx) const {
+		return begin() + (search_type::_find(key, ctx) - m_keys.data());
+	}
+	/**
+	 * \brief find() for a whole range of sorted or unsorted keys
+	 * \param out receives the row index of every key, size() if the key was not found
+	 */
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt find_many(InputIt first, InputIt last, OutputIt out) const {
+		return find_many(first, last, out, m_ctx);
+	}
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt find_many(InputIt first, InputIt last, OutputIt out, context_type &ctx) const {
+		return search_type::_search_many(first, last, out, true, ctx);
+	}
+	/**
+	 * \brief lower_bound() for a whole range of sorted or unsorted keys
+	 * \param out receives the row index of every lower bound, size() if there is none
+	 */
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt lower_bound_many(InputIt first, InputIt last, OutputIt out) const {
+		return lower_bound_many(first, last, out, m_ctx);
+	}
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt lower_bound_many(InputIt first, InputIt last, OutputIt out, context_type &ctx) const {
+		return search_type::_search_many(first, last, out, false, ctx);
+	}
+	inline iterator upper_bound(const K &key) {
+		return begin() + (search_type::_upper_bound(key, m_ctx) - m_keys.data());
+	}
+	inline const_iterator upper_bound(const K &key) const {
+		return upper_bound(key, m_ctx);
+	}
+	/// upper_bound() using the given search context, safe to call from several threads at once
+	inline const_iterator upper_bound(const K &key, context_type &ctx) const {
+		return begin() + (search_type::_upper_bound(key, ctx) - m_keys.data());
+	}
+	inline std::pair<iterator, iterator> equal_range(const K &key) {
+		auto first = lower_bound(key);
+		return std::make_pair(first, first != end() && first.key() == key ? first + 1 : first);
+	}
+	inline std::pair<const_iterator, const_iterator> equal_range(const K &key) const {
+		return equal_range(key, m_ctx);
+	}
+	/// equal_range() using the given search context, safe to call from several threads at once
+	inline std::pair<const_iterator, const_iterator> equal_range(const K &key, context_type &ctx) const {
+		auto first = lower_bound(key, ctx);
+		return std::make_pair(first, first != end() && first.key() == key ? first + 1 : first);
+	}
+
+	/// read-only access to the contiguous key column
+	inline const std::vector<K> &keys() const noexcept { return m_keys; }
+	/// read-only access to the contiguous value column I
+	template<size_t I>
+	inline const std::vector<value_type_of<I>> &column() const noexcept { return std::get<I>(m_columns); }
+
+protected:
+	template<size_t I>
+	inline std::vector<value_type_of<I>> &_column() noexcept { return std::get<I>(m_columns); }
+	template<size_t I>
+	inline const std::vector<value_type_of<I>> &_column() const noexcept { return std::get<I>(m_columns); }
+
+	template<typename F>
+	inline void _for_each_column(F f) { _for_each_column(f, columns()); }
+	template<typename F, size_t... I>
+	inline void _for_each_column(F &f, std::index_sequence<I...>) {
+		(void)std::initializer_list<int>{ (f(std::get<I>(m_columns)), 0)... };
+	}
+	template<size_t... I, typename... Args>
+	inline void _emplace_back(std::index_sequence<I...>, Args&&... values) {
+		(void)std::initializer_list<int>{ (std::get<I>(m_columns).emplace_back(std::forward<Args>(values)), 0)... };
+	}
+	template<size_t... I>
+	inline void _push_back(const value_type &row, std::index_sequence<I...>) {
+		emplace_back(std::get<0>(row), std::get<I + 1>(row)...);
+	}
+	template<typename Ref, typename Self, size_t... I>
+	static inline Ref _row(Self &self, size_t idx, std::index_sequence<I...>) {
+		return Ref(self.m_keys[idx], std::get<I>(self.m_columns)[idx]...);
+	}
+
+	inline void _refresh() {
+		search_type::_refresh(m_keys.data(), m_keys.size());
+	}
+	inline void _append() {
+		search_type::_append(m_keys.data(), m_keys.size());
+	}
+
+private:
+	/// key column, searched by find() and lower_bound()
+	std::vector<K> m_keys;
+	/// one value column per type in V..., only accessed once a key has been found
+	std::tuple<std::vector<V>...> m_columns;
+};
+
+template<typename Stats, typename K, typename... V>
+constexpr size_t basic_tuple_panel<Stats, K, V...>::column_count;
+
+/// panel with a key column of type K and one value column per type in V..., e.g.
+/// tuple_panel<time_t, double, double, int> for bid, ask and size
+template<typename K, typename... V>
+using tuple_panel = basic_tuple_panel<no_search_stats, K, V...>;
+
+#endif /* __tuple_panel_h */
@@ -7,23 +7,934 @@
 #ifndef __tuple_vector_h
 #define __tuple_vector_h
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <limits>
 #include <stdexcept>
 #include <vector>
 #include <iostream>
 #include <iomanip>
 #include <memory>
+#include <string>
+#include <type_traits>
+
+#include "aggregate_index.h"
+#include "simd_scan.h"
+
+/// number of keys find_many() and lower_bound_many() resolve together
+#ifndef TUPLE_VECTOR_BATCH_SIZE
+#define TUPLE_VECTOR_BATCH_SIZE 16
+#endif
+
+/// default maximum error of the learned index built by build_index()
+#ifndef TUPLE_VECTOR_INDEX_EPSILON
+#define TUPLE_VECTOR_INDEX_EPSILON 16
+#endif
+
+/// number of elements scanned linearly after a missed interpolation guess before galloping
+#ifndef TUPLE_VECTOR_SCAN_LIMIT
+#define TUPLE_VECTOR_SCAN_LIMIT 64
+#endif
+
+/**
+ * \brief is_exact_key is true for key types which are interpolated exactly in 64/128 bit integer
+ *		arithmetic instead of through the double returned by key<K>: all integral types and
+ *		std::chrono durations and time points with an integral representation. Other key
+ *		types can opt in by specialising it as std::true_type and providing a key_codec<K>.
+ * \tparam K key type
+ */
+template<typename K>
+struct is_exact_key : std::is_integral<K> { };
+
+template<typename R, typename P>
+struct is_exact_key<std::chrono::duration<R,P>> : std::is_integral<R> { };
+
+template<typename C, typename D>
+struct is_exact_key<std::chrono::time_point<C,D>> : is_exact_key<D> { };
 
 /**
  * \brief key functor used to do numerical calculations with the given type K
- * 		since not all date/time types are readily convertible into numeric types
- * 		the user has to provide a template specialisation
+ * 		Integral and std::chrono keys are supported out of the box. Since not all other
+ * 		date/time types are readily convertible into numeric types, the user has to provide
+ * 		a template specialisation for them, e.g. template<> double key<T>::operator()(...).
  * \tparam K this should be the same key type as used for the tuple_vector definition
  */
-template<typename K>
+template<typename K, typename = void>
 struct key {
     double operator()(const K &x) const;
 };
 
+template<typename K>
+struct key<K, typename std::enable_if<std::is_arithmetic<K>::value>::type> {
+	inline double operator()(const K &x) const { return (double)x; }
+};
+
+template<typename R, typename P>
+struct key<std::chrono::duration<R,P>> {
+	inline double operator()(const std::chrono::duration<R,P> &x) const { return (double)x.count(); }
+};
+
+template<typename C, typename D>
+struct key<std::chrono::time_point<C,D>> {
+	inline double operator()(const std::chrono::time_point<C,D> &x) const { return (double)x.time_since_epoch().count(); }
+};
+
+/**
+ * \brief key_codec converts keys to 64 bit integers and back, the conversion must preserve the
+ *		order and the distance between keys (modulo 2^64, so unsigned 64 bit keys are fine)
+ *		It is used for the exact interpolation of is_exact_key types and by
+ *		compressed_tuple_vector. Integral and std::chrono keys are supported out of the box,
+ *		for anything else the user has to provide a template specialisation, just like for key<K>.
+ * \tparam K key type
+ */
+template<typename K, typename = void>
+struct key_codec {
+	static int64_t encode(const K &x);
+	static K decode(int64_t x);
+};
+
+template<typename K>
+struct key_codec<K, typename std::enable_if<std::is_integral<K>::value>::type> {
+	static inline int64_t encode(const K &x) { return (int64_t)x; }
+	static inline K decode(int64_t x) { return (K)x; }
+};
+
+template<typename R, typename P>
+struct key_codec<std::chrono::duration<R,P>, typename std::enable_if<std::is_integral<R>::value>::type> {
+	static inline int64_t encode(const std::chrono::duration<R,P> &x) { return (int64_t)x.count(); }
+	static inline std::chrono::duration<R,P> decode(int64_t x) { return std::chrono::duration<R,P>((R)x); }
+};
+
+template<typename C, typename D>
+struct key_codec<std::chrono::time_point<C,D>, typename std::enable_if<is_exact_key<D>::value>::type> {
+	static inline int64_t encode(const std::chrono::time_point<C,D> &x) { return key_codec<D>::encode(x.time_since_epoch()); }
+	static inline std::chrono::time_point<C,D> decode(int64_t x) { return std::chrono::time_point<C,D>(key_codec<D>::decode(x)); }
+};
+
+/**
+ * \brief element_key functor used to get at the key part of an element the interpolation search
+ *		runs over - this is either a std::pair<K,V> (tuple_vector) or a plain K (the key column
+ *		of columnar_tuple_vector)
+ * \tparam K key type
+ * \tparam T element type
+ */
+template<typename K, typename T>
+struct element_key {
+	inline const K &operator()(const T &x) const { return x; }
+};
+
+template<typename K, typename V>
+struct element_key<K, std::pair<K,V>> {
+	inline const K &operator()(const std::pair<K,V> &x) const { return x.first; }
+};
+
+/// number of buckets of the resync distance histograms of search_stats_snapshot
+#define TUPLE_VECTOR_STATS_BUCKETS 65
+
+/**
+ * \brief statistics of the lookups done with one search context, see search_stats
+ *		The resync distance is the number of elements between the initial interpolation guess
+ *		and the element a lookup finally landed on. Bucket 0 of the histograms counts distance
+ *		0, bucket b > 0 distances in [2^(b-1), 2^b).
+ */
+struct search_stats_snapshot {
+	/// lookups which found the sought key right at the initial guess
+	uint64_t hits = 0;
+	/// lookups which had to scan from the initial guess
+	uint64_t resyncs = 0;
+	/// initial guesses before the first element, clamped to it
+	uint64_t outofbound_front = 0;
+	/// initial guesses past the last element, clamped to it
+	uint64_t outofbound_back = 0;
+	/// histogram of the resync distances towards the back
+	uint64_t forward[TUPLE_VECTOR_STATS_BUCKETS] = {};
+	/// histogram of the resync distances towards the front
+	uint64_t backward[TUPLE_VECTOR_STATS_BUCKETS] = {};
+
+	/// number of lookups
+	uint64_t lookups() const { return hits + resyncs; }
+	/// number of out-of-bounds guesses
+	uint64_t outofbound() const { return outofbound_front + outofbound_back; }
+	/// fraction of lookups which found the sought key right at the initial guess
+	double hit_rate() const { return lookups() ? (double)hits / lookups() : 0; }
+
+	/**
+	 * \brief distance below which the given fraction of all resync distances lie, i.e. the upper
+	 *		end of the histogram bucket containing that quantile, 0 if there were no resyncs
+	 */
+	uint64_t resync_quantile(double q) const {
+		if (resyncs == 0)
+			return 0;
+		uint64_t n = (uint64_t)(q * resyncs), seen = 0;
+		for (int b = 0; b < TUPLE_VECTOR_STATS_BUCKETS; ++b) {
+			seen += forward[b] + backward[b];
+			if (seen > n)
+				return b ? ((uint64_t)1 << (b - 1)) * 2 - 1 : 0;
+		}
+		return std::numeric_limits<uint64_t>::max();
+	}
+
+	/**
+	 * \brief write all counters as tab separated "name value" lines, every name prefixed with
+	 *		prefix (e.g. the name of the series), histograms as "forward.<b>" and "backward.<b>"
+	 *		for their non-empty buckets
+	 */
+	void write(std::ostream &os, const std::string &prefix = "") const {
+		os << prefix << "hits\t" << hits << '\n'
+			<< prefix << "resyncs\t" << resyncs << '\n'
+			<< prefix << "outofbound_front\t" << outofbound_front << '\n'
+			<< prefix << "outofbound_back\t" << outofbound_back << '\n';
+		for (int b = 0; b < TUPLE_VECTOR_STATS_BUCKETS; ++b)
+			if (forward[b])
+				os << prefix << "forward." << b << '\t' << forward[b] << '\n';
+		for (int b = 0; b < TUPLE_VECTOR_STATS_BUCKETS; ++b)
+			if (backward[b])
+				os << prefix << "backward." << b << '\t' << backward[b] << '\n';
+	}
+};
+
+/**
+ * \brief statistics policy which does not record anything, the default
+ *		All methods are empty, so lookups do not pay anything for statistics.
+ */
+struct no_search_stats {
+	inline void hit() { }
+	inline void resync(ptrdiff_t) { }
+	inline void outofbound(bool) { }
+	/// always empty
+	search_stats_snapshot snapshot() const { return search_stats_snapshot(); }
+};
+
+/**
+ * \brief statistics policy which counts hits, resyncs and out-of-bounds guesses in 64 bit
+ *		counters and keeps histograms of the resync distances, see search_stats_snapshot
+ *		Select it with e.g. tuple_vector<K, V, search_stats> to monitor how well the
+ *		interpolation fits a series.
+ */
+class search_stats {
+public:
+	inline void hit() { ++m_stats.hits; }
+	inline void resync(ptrdiff_t d) {
+		++m_stats.resyncs;
+		if (d >= 0)
+			++m_stats.forward[_bucket(d)];
+		else
+			++m_stats.backward[_bucket(-d)];
+	}
+	inline void outofbound(bool back) { ++(back ? m_stats.outofbound_back : m_stats.outofbound_front); }
+	/// copy of all counters
+	search_stats_snapshot snapshot() const { return m_stats; }
+
+private:
+	/// histogram bucket of resync distance d
+	static inline int _bucket(uint64_t d) { return d ? 64 - __builtin_clzll(d) : 0; }
+
+	search_stats_snapshot m_stats;
+};
+
+/**
+ * \brief basic_search_context holds the adaptive state of the interpolation search, i.e. the
+ *		offset learned from previous lookups, plus the statistics selected by the Stats policy.
+ *		Every container has a built-in context which is used by find(key), lower_bound(key)
+ *		etc. - these calls are const but still modify the container and must not be called
+ *		concurrently. Threads sharing a container pass their own context instead, e.g.
+ *		find(key, ctx), which only ever reads from the container and can be called from any
+ *		number of threads at once, as long as no thread modifies the container at the same time.
+ * \tparam Stats statistics policy, no_search_stats or search_stats
+ */
+template<typename Stats = no_search_stats>
+class basic_search_context {
+public:
+	typedef Stats stats_type;
+
+	/// reset the learned offset and all statistics
+	void reset() { *this = basic_search_context(); }
+
+	/// snapshot of the statistics of all lookups with this context, empty for no_search_stats
+	search_stats_snapshot stats() const { return m_stats.snapshot(); }
+
+	uint64_t hits() const { return stats().hits; }
+	uint64_t outofbound() const { return stats().outofbound(); }
+	uint64_t resync() const { return stats().resyncs; }
+	double avg_diff() const { return m_avg_diff; }
+
+private:
+	template<typename, typename, typename> friend class interpolation_search;
+
+	/// offset added to the initial interpolation guess to compensate for "time" gaps
+	int m_offset = 0;
+	/// running average difference between key we guessed at first try and key we landed on after resync
+	double m_avg_diff = 0;
+	/// number of resyncs averaged in m_avg_diff
+	uint64_t m_samples = 0;
+	/// lookup statistics
+	Stats m_stats;
+};
+
+/// search context of containers without statistics
+typedef basic_search_context<> search_context;
+
+/**
+ * \brief This class implements the interpolation search on a contiguous sequence of elements
+ *		with strictly increasing keys together with the internal book-keeping variables needed
+ *		for it. It is shared by all container layouts, i.e. tuple_vector, which searches the
+ *		std::pair<K,V> elements directly, and columnar_tuple_vector, which only searches its
+ *		key column.
+ *		The book-keeping variables ("model") only depend on the sequence itself, all modifying
+ *		operations of a derived container need to call _refresh() to keep them up-to-date, or
+ *		the cheaper _append() if elements were only added at the back.
+ *		Everything learned from previous lookups is kept in a search_context, so searches with
+ *		a caller-provided context do not write to the container at all.
+ * \tparam K A datetime type, e.g. time_t, boost::posix_time::ptime or similar.
+ * \tparam T The element type being searched, either std::pair<K,V> or K.
+ * \tparam Stats statistics policy of the search contexts, no_search_stats or search_stats
+ */
+template<typename K, typename T, typename Stats = no_search_stats>
+class interpolation_search {
+public:
+	/// search context type accepted by the lookups of the derived container
+	typedef basic_search_context<Stats> context_type;
+
+	/// Reset housekeeping variables. Just for completeness - normally you don't need to call this.
+	void reset() {
+		m_ctx.reset();
+		m_recompute = 0;
+	}
+
+	uint64_t hits() const { return m_ctx.hits(); }
+	uint64_t outofbound() const { return m_ctx.outofbound(); }
+	int recompute() const { return m_recompute; }
+	uint64_t resync() const { return m_ctx.resync(); }
+	double avg_diff() const { return m_ctx.avg_diff(); }
+
+	/// snapshot of the statistics of the built-in search context, empty for no_search_stats
+	search_stats_snapshot stats() const { return m_ctx.stats(); }
+
+	/// the built-in search context used by all lookups without an explicit context
+	const context_type &context() const { return m_ctx; }
+
+	/**
+	 * \brief build an optional "learned index" over all keys
+	 *		The single interpolation line used by default is a poor fit for keys with sessions,
+	 *		overnight gaps or bursts. The learned index instead splits the keys in one pass into
+	 *		linear segments, each of which predicts the position of any of its keys within
+	 *		+-epsilon elements (like the PGM-index or RadixSpline). A lookup then only has to find
+	 *		the segment (binary search over the segment keys) and search a window of 2*epsilon+1
+	 *		elements, regardless of how the keys are distributed.
+	 *		Once built, the index is kept up-to-date by all modifying operations: appends extend
+	 *		it, everything else rebuilds it.
+	 * \param epsilon maximum prediction error in elements
+	 */
+	void build_index(size_t epsilon = TUPLE_VECTOR_INDEX_EPSILON) {
+		m_epsilon = epsilon ? epsilon : 1;
+		m_segments.clear();
+		m_segment_keys.clear();
+		_index_extend(0);
+	}
+
+	/// remove the learned index, lookups go back to the interpolation search
+	void drop_index() {
+		m_epsilon = 0;
+		std::vector<segment>().swap(m_segments);
+		std::vector<K>().swap(m_segment_keys);
+	}
+
+	/// number of linear segments in the learned index
+	size_t index_segments() const { return m_segments.size(); }
+	/// memory used by one segment of the learned index in bytes
+	static constexpr size_t index_segment_bytes() { return sizeof(segment) + sizeof(K); }
+	/// memory used by the learned index in bytes
+	size_t index_bytes() const { return m_segments.capacity() * sizeof(segment) + m_segment_keys.capacity() * sizeof(K); }
+
+protected:
+	/// one linear segment of the learned index
+	struct segment {
+		/// numerical representation of the first key in this segment
+		double key;
+		/// elements per key unit
+		double slope;
+		/// index of the first element in this segment
+		size_t index;
+	};
+
+	/**
+	 * \brief add the elements from index "from" up to m_size to the learned index
+	 *		Every segment is anchored at its first element. For each following element the range
+	 *		of slopes that predict it within +-m_epsilon is intersected with the slope range of
+	 *		the segment so far ("shrinking cone"). If the intersection becomes empty, the element
+	 *		starts a new segment. The slope of the last segment is the middle of its cone.
+	 */
+	void _index_extend(size_t from)
+	{
+		const element_key<K,T> kf;
+		for (size_t i = from; i < m_size; ++i) {
+			// only the first element of a run of equal keys needs to be predicted
+			if (i && !(kf(m_front[i-1]) < kf(m_front[i])))
+				continue;
+			double x = ::key<K>()(kf(m_front[i]));
+			if (!m_segments.empty()) {
+				segment &seg = m_segments.back();
+				double dx = x - seg.key;
+				double dy = (double)i - (double)seg.index;
+				double lo = (dy - m_epsilon) / dx, hi = (dy + m_epsilon) / dx;
+				if (dx > 0 && lo <= m_slope_hi && hi >= m_slope_lo) {
+					m_slope_lo = std::max(m_slope_lo, lo);
+					m_slope_hi = std::min(m_slope_hi, hi);
+					seg.slope = (m_slope_lo + m_slope_hi) / 2;
+					continue;
+				}
+			}
+			m_segments.push_back(segment{x, 0, i});
+			m_segment_keys.push_back(kf(m_front[i]));
+			m_slope_lo = 0;
+			m_slope_hi = std::numeric_limits<double>::infinity();
+		}
+	}
+
+	/**
+	 * \brief lower bound search using the learned index
+	 * \return pointer to the first element not less than key or _end() if there is none
+	 */
+	inline const T *_index_lower_bound(const K &key) const
+	{
+		const element_key<K,T> kf;
+		// find the segment containing key
+		size_t s = std::upper_bound(m_segment_keys.begin(), m_segment_keys.end(), key) - m_segment_keys.begin();
+		if (s == 0)
+			return m_front;
+		const segment &seg = m_segments[s-1];
+		// the lower bound is somewhere in [seg.index, seg_end]
+		double seg_end = s < m_segments.size() ? m_segments[s].index : m_size;
+		double pos = seg.index + seg.slope * (::key<K>()(key) - seg.key);
+		double l = std::min(std::max<double>(seg.index, pos - m_epsilon), seg_end);
+		double h = std::max(std::min(seg_end, pos + m_epsilon + 1), l);
+		const T *lo = m_front + (size_t)l, *hi = m_front + (size_t)h;
+		// probe the predicted position first, an exact prediction only costs two compares
+		if (lo < hi) {
+			const T *rc = m_front + (size_t)std::min(std::max(pos, l), h - 1);
+			if (kf(*rc) < key)
+				lo = rc + 1;
+			else if (rc == m_front || kf(rc[-1]) < key)
+				return rc;
+			else
+				hi = rc - 1;
+		}
+		// guard against rounding errors: everything before lo must be less than key and hi must not be
+		if (lo > m_front && !(kf(lo[-1]) < key))
+			lo = m_front;
+		if (hi < _end() && kf(*hi) < key)
+			hi = _end();
+		return std::lower_bound(lo, hi, key, [&kf](const T &a, const K &b) { return kf(a) < b; });
+	}
+
+	/**
+	 * \brief update internal house-keeping variables after the sequence was modified
+	 * \param first pointer to the first element of the sequence
+	 * \param n number of elements in the sequence
+	 */
+	inline void _refresh(const T *first, size_t n)
+	{
+		// get current size of vector
+		m_size = n;
+		m_ctx.m_offset = 0;
+		// get pointer to first element - this serves as the lower bound when searching for key
+		m_front = first;
+		// get pointer to last element - this serves as the upper bound when searching for key
+		m_back = n ? first + n - 1 : first;
+		if (m_size)
+			_fit(is_exact_key<K>());
+		// keep a count of how many times we were called
+		++m_recompute;
+		// rebuild the learned index if there is one
+		if (m_epsilon)
+			build_index(m_epsilon);
+	}
+
+	/**
+	 * \brief point the model at another buffer holding the very same elements, e.g. after a copy
+	 *		or a move, without recomputing anything - the interpolation line and the learned index
+	 *		only depend on the keys and positions of the elements
+	 * \param first pointer to the first element of the sequence
+	 */
+	inline void _rebase(const T *first) noexcept
+	{
+		m_front = first;
+		m_back = m_size ? first + m_size - 1 : first;
+	}
+
+	/**
+	 * \brief forget the sequence and the learned index, e.g. for the source of a move
+	 * \param first pointer to the first element of the now empty sequence
+	 */
+	inline void _reset(const T *first) noexcept
+	{
+		*this = interpolation_search();
+		_rebase(first);
+	}
+
+	/**
+	 * \brief update internal house-keeping variables after elements were appended
+	 *		As long as the sequence was not reallocated and the new back key is past the old one,
+	 *		only size, back pointer and ranges are updated, so the offset learned by the search
+	 *		context survives. Anything else, e.g. a reallocation, results in a full _refresh().
+	 * \param first pointer to the first element of the sequence
+	 * \param n number of elements in the sequence
+	 */
+	inline void _append(const T *first, size_t n)
+	{
+		const element_key<K,T> kf;
+		if (first != m_front || m_size == 0 || n <= m_size || kf(first[n-1]) < kf(*m_back))
+			return _refresh(first, n);
+		size_t old_size = m_size;
+		m_size = n;
+		m_back = first + n - 1;
+		_fit(is_exact_key<K>());
+		if (m_epsilon)
+			_index_extend(old_size);
+	}
+
+	/**
+	 * \brief fit the interpolation line through the front and back elements, double version
+	 *		for key types which are only known through key<K>
+	 */
+	inline void _fit(std::false_type)
+	{
+		const element_key<K,T> kf;
+		// calculate the "total range" or time difference between front and back elements
+		m_front_key = ::key<K>()(kf(*m_front));
+		m_total_range = ::key<K>()(kf(*m_back)) - m_front_key;
+		// how much "time" does one element occupy
+		m_element_range = m_size > 1 ? m_total_range / (m_size-1) : 1;
+	}
+
+	/**
+	 * \brief fit the interpolation line through the front and back elements, exact version for
+	 *		is_exact_key types
+	 *		Instead of the "time" one element occupies, its reciprocal is kept as a fixed point
+	 *		number with m_shift fraction bits, so _interpolate() needs one multiplication instead
+	 *		of a division. It is at most 1.0 for strictly increasing keys, which leaves 63
+	 *		fraction bits. Only non-decreasing keys (see multi_tuple_vector) can have more than
+	 *		one element per key unit, the integer part then takes the bits it needs from the fraction.
+	 */
+	inline void _fit(std::true_type)
+	{
+		const element_key<K,T> kf;
+		m_front_code = key_codec<K>::encode(kf(*m_front));
+		const uint64_t range = (uint64_t)key_codec<K>::encode(kf(*m_back)) - (uint64_t)m_front_code;
+		m_shift = 63;
+		if (range == 0) {
+			m_reciprocal = 0;
+			return;
+		}
+		if (range < m_size - 1)
+			for (uint64_t q = (m_size - 1) / range; q; q >>= 1)
+				--m_shift;
+#ifdef __SIZEOF_INT128__
+		m_reciprocal = (uint64_t)(((unsigned __int128)(m_size - 1) << m_shift) / range);
+#else
+		m_reciprocal = (uint64_t)std::ldexp((long double)(m_size - 1) / range, m_shift);
+#endif
+	}
+
+	/**
+	 * \brief position of key on the interpolation line, double version, see _fit()
+	 * \return element index, may be out of bounds
+	 */
+	inline double _interpolate(const K &key, std::false_type) const
+	{
+		return (::key<K>()(key) - m_front_key) / m_element_range;
+	}
+
+	/**
+	 * \brief position of key on the interpolation line, exact version, see _fit()
+	 *		The distance to the front key is computed in 64 bit integers, so e.g. nanosecond
+	 *		timestamps do not lose their low bits like they would as a double, and scaled with
+	 *		a 64x64->128 bit multiplication. The result is the exact index truncated to an
+	 *		integer, which is always representable as a double when it is within bounds.
+	 * \return element index, may be out of bounds
+	 */
+	inline double _interpolate(const K &key, std::true_type) const
+	{
+		if (key < element_key<K,T>()(*m_front))
+			return -1;
+		const uint64_t d = (uint64_t)key_codec<K>::encode(key) - (uint64_t)m_front_code;
+#ifdef __SIZEOF_INT128__
+		const unsigned __int128 idx = ((unsigned __int128)d * m_reciprocal) >> m_shift;
+		// only possible with fewer than 63 fraction bits, far beyond the back element anyway
+		if (idx >> 64)
+			return (double)m_size;
+		return (double)(uint64_t)idx;
+#else
+		return (double)d * std::ldexp((double)m_reciprocal, -(int)m_shift);
+#endif
+	}
+
+	/**
+	 * \brief position of key on the interpolation line through the front and back elements,
+	 *		using exact integer arithmetic for is_exact_key types and key<K> for anything else
+	 * \return element index, may be out of bounds
+	 */
+	inline double _interpolate(const K &key) const { return _interpolate(key, is_exact_key<K>()); }
+
+	/// pointer one past the last element of the sequence, returned when a search fails
+	inline const T *_end() const { return m_front + m_size; }
+
+	/**
+	 * \brief compute the initial guess where we could find the searched key by interpolating
+	 * \return pointer to the guessed element, clamped to front or back if out-of-bounds
+	 */
+	inline const T *_guess(const K &key, context_type &ctx) const
+	{
+		double idx = _interpolate(key) + ctx.m_offset;
+
+		// check bounds first
+		if (idx >= 0 && idx < m_size) {
+			// ok, we are within bounds - get element
+			return m_front + (size_t)idx;
+		}
+		ctx.m_offset = 0;
+		// maintain an out-of-bounds counter for information purposes
+		ctx.m_stats.outofbound(idx > 0);
+		// out-of-bounds, get either front or back element, depending on the index
+		return idx > 0 ? m_back : m_front;
+	}
+
+	/**
+	 * \brief step forward from rc until reaching the first key not less than key or m_back
+	 *		The first TUPLE_VECTOR_SCAN_LIMIT elements are scanned linearly, which is the fast path
+	 *		when the interpolation guess was good. If that is not enough, the search gallops with
+	 *		exponentially growing steps and finishes with a binary search, so a bad guess costs
+	 *		O(log n) instead of O(n).
+	 */
+	inline const T *_scan_forward(const T *rc, const K &key) const
+	{
+		const element_key<K,T> kf;
+		const T *end = m_back - rc > TUPLE_VECTOR_SCAN_LIMIT ? rc + TUPLE_VECTOR_SCAN_LIMIT : m_back;
+		// compare whole blocks of keys at once where possible, finish with the scalar loop
+		rc += simd_scan::forward(&kf(*rc), end - rc, sizeof(T), key);
+		for (; kf(*rc) < key && rc < end; ++rc);
+		if (rc < end || rc == m_back || kf(*rc) >= key)
+			return rc;
+		// gallop forward: the key at lo is always less than the sought key
+		const T *lo = rc, *hi = m_back;
+		for (size_t step = 2 * TUPLE_VECTOR_SCAN_LIMIT; (size_t)(m_back - lo) > step; step *= 2) {
+			if (kf(lo[step]) >= key) {
+				hi = lo + step;
+				break;
+			}
+			lo += step;
+		}
+		// first element in (lo, hi) not less than key, or hi
+		return std::lower_bound(lo + 1, hi, key, [&kf](const T &a, const K &b) { return kf(a) < b; });
+	}
+
+	/// step backward from rc until reaching the last key not greater than key or m_front, see _scan_forward()
+	inline const T *_scan_backward(const T *rc, const K &key) const
+	{
+		const element_key<K,T> kf;
+		const T *end = rc - m_front > TUPLE_VECTOR_SCAN_LIMIT ? rc - TUPLE_VECTOR_SCAN_LIMIT : m_front;
+		rc -= simd_scan::backward(&kf(*rc), rc - end, sizeof(T), key);
+		for (; kf(*rc) > key && rc > end; --rc);
+		if (rc > end || rc == m_front || kf(*rc) <= key)
+			return rc;
+		// gallop backward: the key at hi is always greater than the sought key
+		const T *lo = m_front, *hi = rc;
+		for (size_t step = 2 * TUPLE_VECTOR_SCAN_LIMIT; (size_t)(hi - m_front) > step; step *= 2) {
+			if (kf(hi[-(ptrdiff_t)step]) <= key) {
+				lo = hi - step;
+				break;
+			}
+			hi -= step;
+		}
+		// last element in [lo, hi) not greater than key, or m_front
+		const T *p = std::upper_bound(lo, hi, key, [&kf](const K &a, const T &b) { return a < kf(b); });
+		return p == lo ? lo : p - 1;
+	}
+
+	/**
+	 * \brief first element of the run of elements with the same key as rc, for sequences with
+	 *		non-decreasing keys (see multi_tuple_vector)
+	 *		Runs are usually short, so the search gallops backward from rc in steps of 1, 2, 4, ...
+	 *		and finishes with a binary search.
+	 */
+	inline const T *_run_front(const T *rc) const
+	{
+		const element_key<K,T> kf;
+		const K key = kf(*rc);
+		if (rc == m_front || kf(rc[-1]) < key)
+			return rc;
+		// the key at hi is always equal to key
+		const T *hi = rc - 1;
+		size_t step = 1;
+		for (; (size_t)(hi - m_front) >= step && !(kf(hi[-(ptrdiff_t)step]) < key); step *= 2)
+			hi -= step;
+		const T *lo = (size_t)(hi - m_front) >= step ? hi - step : m_front;
+		return std::lower_bound(lo, hi, key, [&kf](const T &a, const K &b) { return kf(a) < b; });
+	}
+
+	/// one past the last element of the run of elements with the same key as rc, see _run_front()
+	inline const T *_run_end(const T *rc) const
+	{
+		const element_key<K,T> kf;
+		const K key = kf(*rc);
+		// the key at lo is always equal to key
+		const T *lo = rc;
+		size_t step = 1;
+		for (; (size_t)(m_back - lo) >= step && !(key < kf(lo[step])); step *= 2)
+			lo += step;
+		const T *hi = (size_t)(m_back - lo) >= step ? lo + step : _end();
+		return std::upper_bound(lo + 1, hi, key, [&kf](const K &a, const T &b) { return a < kf(b); });
+	}
+
+	/// learn from the distance between the initial guess and the element we landed on
+	inline void _resync(const T *old_rc, const T *rc, context_type &ctx) const
+	{
+		ctx.m_stats.resync(rc - old_rc);
+		ctx.m_avg_diff *= ctx.m_samples;
+		ctx.m_avg_diff += rc - old_rc;
+		ctx.m_offset += rc - old_rc;
+		++ctx.m_samples;
+		ctx.m_avg_diff /= ctx.m_samples;
+		ctx.m_offset = (double)ctx.m_offset + ctx.m_avg_diff + .5;
+	}
+
+	/**
+	 * \brief resync from the initial guess rc to the element with the given key
+	 * \return pointer to the element with the given key or _end() if not found
+	 */
+	inline const T *_find_from(const T *rc, const K &key, context_type &ctx) const
+	{
+		const element_key<K,T> kf;
+
+		// if we already found our key, return it
+		if (kf(*rc) == key) {
+			ctx.m_stats.hit();
+			return rc;
+		}
+		const T *old_rc = rc;
+		// perform a search backward or forward, depending on were we landed
+		if (kf(*rc) > key)
+			rc = _scan_backward(rc, key);
+		else
+			rc = _scan_forward(rc, key);
+		_resync(old_rc, rc, ctx);
+
+		// did we find the sought key? return it
+		if (kf(*rc) == key)
+			return rc;
+
+		// not found? return end()
+		return _end();
+	}
+
+	/**
+	 * \brief resync from the initial guess rc to the first element not less than key
+	 * \return pointer to the first element not less than key or _end() if there is none
+	 */
+	inline const T *_lower_bound_from(const T *rc, const K &key, context_type &ctx) const
+	{
+		const element_key<K,T> kf;
+
+		const T *old_rc = rc;
+		if (kf(*rc) > key) {
+			rc = _scan_backward(rc, key);
+			if (kf(*rc) < key)
+				++rc;
+		} else {
+			rc = _scan_forward(rc, key);
+		}
+		// landing right on the initial guess is a hit, just like in _find_from()
+		if (rc == old_rc)
+			ctx.m_stats.hit();
+		else
+			_resync(old_rc, rc, ctx);
+
+		if (kf(*rc) >= key)
+			return rc;
+		return _end();
+	}
+
+	/**
+	 * \brief interpolation search for key
+	 * \param ctx search context to use and update
+	 * \return pointer to the element with the given key or _end() if not found
+	 */
+	inline const T *_find(const K &key, context_type &ctx) const
+	{
+		// if there is no data, we are already done
+		if (m_size == 0)
+			return _end();
+
+		if (m_epsilon) {
+			const T *rc = _index_lower_bound(key);
+			return rc != _end() && element_key<K,T>()(*rc) == key ? rc : _end();
+		}
+
+		return _find_from(_guess(key, ctx), key, ctx);
+	}
+
+	/**
+	 * \brief interpolation search for the first element not less than key
+	 * \param ctx search context to use and update
+	 * \return pointer to the first element not less than key or _end() if there is none
+	 */
+	inline const T *_lower_bound(const K &key, context_type &ctx) const
+	{
+		if (m_size == 0)
+			return _end();
+
+		if (m_epsilon)
+			return _index_lower_bound(key);
+
+		return _lower_bound_from(_guess(key, ctx), key, ctx);
+	}
+
+	/**
+	 * \brief lower_bound() of a key which is known to be not less than the key at from
+	 *		If the result is within TUPLE_VECTOR_SCAN_LIMIT elements, it is found by scanning forward
+	 *		from "from", which the previous lookup has just pulled into the cache, otherwise by a
+	 *		regular interpolation search.
+	 * \return pointer to the first element not less than key or _end() if there is none
+	 */
+	inline const T *_lower_bound_after(const T *from, const K &key, context_type &ctx) const
+	{
+		const element_key<K,T> kf;
+		if (from == _end())
+			return from;
+		if (m_back - from > TUPLE_VECTOR_SCAN_LIMIT && kf(from[TUPLE_VECTOR_SCAN_LIMIT]) < key)
+			return _lower_bound(key, ctx);
+		from = _scan_forward(from, key);
+		return kf(*from) < key ? _end() : from;
+	}
+
+	/**
+	 * \brief interpolation search for the first element greater than key
+	 * \param ctx search context to use and update
+	 * \return pointer to the first element greater than key or _end() if there is none
+	 */
+	inline const T *_upper_bound(const K &key, context_type &ctx) const
+	{
+		const T *rc = _lower_bound(key, ctx);
+		// keys are unique, so only the lower bound itself can be equal to key
+		return rc != _end() && element_key<K,T>()(*rc) == key ? rc + 1 : rc;
+	}
+
+	/**
+	 * \brief batched find() or lower_bound() for a whole range of keys
+	 *		The keys are processed in groups of TUPLE_VECTOR_BATCH_SIZE. A group of increasing keys
+	 *		that are not less than the previous result is resolved by sweeping forward from that
+	 *		result like a merge, since the next result can never be before it. For any
+	 *		other group all interpolation guesses are computed and prefetched first, so that the
+	 *		cache misses of the whole group overlap instead of being paid one after the other.
+	 * \param kfirst first key to search for
+	 * \param klast one past the last key to search for
+	 * \param out receives the index of every result, the sequence size meaning "not found"
+	 * \param find true for find() semantics, false for lower_bound()
+	 * \param ctx search context to use and update
+	 * \return out after the last written index
+	 */
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt _search_many(InputIt kfirst, InputIt klast, OutputIt out, bool find, context_type &ctx) const
+	{
+		const element_key<K,T> kf;
+		const T *first = m_front, *end = _end();
+		const size_t n = m_size;
+		K keys[TUPLE_VECTOR_BATCH_SIZE];
+		const T *rc[TUPLE_VECTOR_BATCH_SIZE];
+		// result of the previous key - the starting point of a forward sweep
+		const T *prev = nullptr;
+
+		while (kfirst != klast) {
+			size_t cnt = 0;
+			bool sorted = true;
+			for (; cnt < TUPLE_VECTOR_BATCH_SIZE && kfirst != klast; ++cnt, ++kfirst) {
+				keys[cnt] = *kfirst;
+				if (cnt && keys[cnt] < keys[cnt-1])
+					sorted = false;
+			}
+			if (m_size == 0) {
+				for (size_t i = 0; i < cnt; ++i)
+					*out++ = n;
+				continue;
+			}
+			if (sorted && prev && kf(*prev) <= keys[0]) {
+				// merge-like sweep, every element before prev is less than keys[0], so the lower
+				// bound of each key is at or after the previous one
+				for (size_t i = 0; i < cnt; ++i) {
+					const T *p = prev;
+					// dense queries usually land on the previous result or the one right after it
+					if (kf(*p) < keys[i] && p < m_back && kf(*++p) < keys[i])
+						p = _scan_forward(p, keys[i]);
+					if (kf(*p) < keys[i]) {
+						// all remaining keys are past the back element
+						for (; i < cnt; ++i)
+							*out++ = n;
+						break;
+					}
+					prev = p;
+					*out++ = (find && kf(*p) != keys[i]) ? n : p - first;
+				}
+				continue;
+			}
+			if (m_epsilon) {
+				for (size_t i = 0; i < cnt; ++i) {
+					const T *p = find ? _find(keys[i], ctx) : _lower_bound(keys[i], ctx);
+					*out++ = p == end ? n : p - first;
+					if (p != end)
+						prev = p;
+				}
+				continue;
+			}
+			// compute and prefetch all guesses before touching any of them
+			for (size_t i = 0; i < cnt; ++i) {
+				rc[i] = _guess(keys[i], ctx);
+				__builtin_prefetch(rc[i]);
+			}
+			for (size_t i = 0; i < cnt; ++i) {
+				const T *p = find ? _find_from(rc[i], keys[i], ctx) : _lower_bound_from(rc[i], keys[i], ctx);
+				*out++ = p == end ? n : p - first;
+				if (p != end)
+					prev = p;
+			}
+		}
+		return out;
+	}
+
+	/// number of elements currently in the searched sequence
+	size_t m_size = 0;
+	/// numerical representation of the first key, i.e. key<K>()(m_front->first)
+	double m_front_key = 0;
+	/// "total range" or time difference between first and last element in the searched sequence
+	double m_total_range = 0;
+	/// how much "time" does one element occupy within the searched sequence (adjusted)
+	double m_element_range = 0;
+	/// key_codec<K> encoding of the first key, is_exact_key types only
+	int64_t m_front_code = 0;
+	/// elements per key unit as a fixed point number, is_exact_key types only
+	uint64_t m_reciprocal = 0;
+	/// number of fraction bits of m_reciprocal
+	unsigned m_shift = 63;
+	/// how often the internal housekeeping code was called
+	int m_recompute = 0;
+	/// pointer to the first element in the searched sequence
+	const T *m_front = nullptr;
+	/// pointer to the last element in the searched sequence
+	const T *m_back = nullptr;
+	/// built-in search context, see basic_search_context
+	mutable context_type m_ctx;
+	/// maximum prediction error of the learned index, 0 if there is none
+	size_t m_epsilon = 0;
+	/// segments of the learned index
+	std::vector<segment> m_segments;
+	/// first key of every segment, kept separately for a cache friendly segment search
+	std::vector<K> m_segment_keys;
+	/// cone of feasible slopes of the last segment
+	double m_slope_lo = 0, m_slope_hi = 0;
+};
+
 /**
  * \brief This class is a custom container based on std::vector containing std::pair<K,V> tuples
  *		for *fast* find() and lower_bound() operations on strictly increasing timeseries.
@@ -31,333 +942,394 @@ struct key {
  *		timeseries by implementing an interpolation search with ~O(log log n) complexity.
  *		The container does not sort, so any data needs to be presorted. This is generally the
  *		case if your use-case involves reading timeseries data from a database or receiving
- *		it via some data provider api.
- *		All modifying operations need to set m_recompute_range to true so that find() and
- *		lower_bound() can update internal book-keeping variables.
+ *		it via some data provider api, anything else can be loaded with bulk_load().
+ *		All modifying operations need to call _refresh() (or _append() when appending) so that
+ *		find() and lower_bound() can rely on up-to-date internal book-keeping variables.
+ *		The search itself is implemented in interpolation_search, see columnar_tuple_vector for
+ *		a variant storing keys and values in separate columns.
+ *		Time window aggregates are answered by aggregate(), see build_aggregates().
  * \tparam K A datetime type, e.g. time_t, boost::posix_time::ptime or similar.
  * \tparam V A value type, can be whatever is appropriate for the use-case.
+ * \tparam Stats lookup statistics policy, no_search_stats (default) or search_stats
+ * \tparam Allocator allocator of the elements, e.g. huge_page_allocator or arena_allocator
+ *		(see allocators.h)
  */
-template<typename K, typename V>
-class tuple_vector : public std::vector<std::pair<K,V>> {
+template<typename K, typename V, typename Stats = no_search_stats, typename Allocator = std::allocator<std::pair<K,V>>>
+class tuple_vector : public std::vector<std::pair<K,V>, Allocator>, public interpolation_search<K, std::pair<K,V>, Stats> {
+	typedef interpolation_search<K, std::pair<K,V>, Stats> search_type;
+	typedef std::vector<std::pair<K,V>, Allocator> base_type;
+protected:
+	using search_type::m_ctx;
 public:
 	typedef std::pair<K,V>										value_type;
-	typedef typename std::vector<value_type>::iterator			iterator;
-	typedef typename std::vector<value_type>::const_iterator	const_iterator;
-	typedef typename std::vector<value_type>::size_type			size_type;
+	typedef Allocator											allocator_type;
+	typedef typename base_type::iterator						iterator;
+	typedef typename base_type::const_iterator					const_iterator;
+	typedef typename base_type::size_type						size_type;
+	typedef typename search_type::context_type					context_type;
 
 	tuple_vector() { }
 
-	tuple_vector(size_type n) : std::vector<value_type>(n) { }
+	explicit tuple_vector(const allocator_type &alloc) : base_type(alloc) { }
+
+	tuple_vector(size_type n, const allocator_type &alloc = allocator_type()) : base_type(n, alloc) { _refresh(); }
+
+	/// copy of the elements in [first, last), which must be sorted by strictly increasing keys
+	template<typename InputIt, typename = typename std::enable_if<
+		std::is_base_of<std::input_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value>::type>
+	tuple_vector(InputIt first, InputIt last, const allocator_type &alloc = allocator_type()) : base_type(first, last, alloc) { _refresh(); }
+
+	tuple_vector(std::initializer_list<value_type> il, const allocator_type &alloc = allocator_type()) : base_type(il, alloc) { _refresh(); }
+
+	/// take over the buffer of x without copying any element, x must be sorted by strictly increasing keys
+	explicit tuple_vector(base_type &&x) : base_type(std::move(x)) { _refresh(); }
+
+	/// copy of x including its learned index and aggregate index, which are copied, not rebuilt
+	tuple_vector(const tuple_vector &x) : base_type(x), search_type(x), m_aggregates(x.m_aggregates) {
+		search_type::_rebase(base_type::data());
+	}
+
+	/// take over the elements, the learned index and the aggregate index of x in O(1), x is left empty
+	tuple_vector(tuple_vector &&x) noexcept : base_type(std::move(x)), search_type(std::move(x)),
+		m_aggregates(std::move(x.m_aggregates)) {
+		search_type::_rebase(base_type::data());
+		x._reset();
+	}
 
 	~tuple_vector() { }
 
 	// Modifying operations.
 	inline void assign (const_iterator first, const_iterator last) {
-		std::vector<value_type>::assign(first, last);
-		m_recompute_range = true;
+		base_type::assign(first, last);
+		_refresh();
 	}
 	inline void assign (size_type n, const value_type& val) {
-		std::vector<value_type>::assign(n, val);
-		m_recompute_range = true;
+		base_type::assign(n, val);
+		_refresh();
 	}
 	inline void assign (std::initializer_list<value_type> il) {
-		std::vector<value_type>::assign(il);
-		m_recompute_range = true;
+		base_type::assign(il);
+		_refresh();
+	}
+	/// take over the buffer of x without copying any element, x must be sorted by strictly increasing keys
+	inline void assign (base_type &&x) {
+		base_type::operator=(std::move(x));
+		_refresh();
 	}
 	void clear() noexcept {
-		std::vector<value_type>::clear();
-		m_recompute_range = true;
+		base_type::clear();
+		_refresh();
 	}
 	template <typename... Args> inline void emplace_back(Args&&... args) {
-		std::vector<value_type>::emplace_back(std::forward<Args>(args)...);
-		m_recompute_range = true;
+		base_type::emplace_back(std::forward<Args>(args)...);
+		_append();
 	}
 	template <typename... Args> inline iterator emplace (const_iterator pos, Args&&... args) {
-		m_recompute_range = true;
-		return std::vector<value_type>::emplace(pos, std::forward<Args>(args)...);
+		auto it = base_type::emplace(pos, std::forward<Args>(args)...);
+		_refresh();
+		return it;
 	}
 	inline void emplace_back(const value_type &p) {
-		std::vector<value_type>::emplace_back(p);
-		m_recompute_range = true;
+		base_type::emplace_back(p);
+		_append();
 	}
 	inline size_type erase(const K &key) {
 		auto pos = find(key);
-		m_recompute_range = true;
-		std::vector<value_type>::erase(pos);
+		if (pos == base_type::end())
+			return 0;
+		base_type::erase(pos);
+		_refresh();
 		return 1;
 	}
 	inline iterator erase(const_iterator pos) {
-		m_recompute_range = true;
-		return std::vector<value_type>::erase(pos);
+		auto it = base_type::erase(pos);
+		_refresh();
+		return it;
 	}
 	inline iterator erase(const_iterator start, const_iterator end) {
-		m_recompute_range = true;
-		return std::vector<value_type>::erase(start, end);
+		auto it = base_type::erase(start, end);
+		_refresh();
+		return it;
 	}
 	inline iterator insert(const_iterator position, const value_type& val) {
-		m_recompute_range = true;
-		return std::vector<value_type>::insert(position, val);
+		auto it = base_type::insert(position, val);
+		_refresh();
+		return it;
 	}
 	inline iterator insert(const_iterator position, size_type n, const value_type& val) {
-		m_recompute_range = true;
-		return std::vector<value_type>::insert(position, n, val);
+		auto it = base_type::insert(position, n, val);
+		_refresh();
+		return it;
 	}
 	inline iterator insert(const_iterator position, const_iterator first, const_iterator last) {
-		m_recompute_range = true;
-		return std::vector<value_type>::insert(position, first, last);
+		auto it = base_type::insert(position, first, last);
+		_refresh();
+		return it;
 	}
 	inline iterator insert(const_iterator position, value_type&& val) {
-		m_recompute_range = true;
-		return std::vector<value_type>::insert(position, std::forward<value_type>(val));
+		auto it = base_type::insert(position, std::forward<value_type>(val));
+		_refresh();
+		return it;
 	}
 	inline iterator insert(const_iterator position, std::initializer_list<value_type> il) {
-		m_recompute_range = true;
-		return std::vector<value_type>::insert(position, il);
+		auto it = base_type::insert(position, il);
+		_refresh();
+		return it;
+	}
+	/**
+	 * \brief merge the elements of [first, last), which must be sorted by strictly increasing
+	 *		keys, into the container in one linear pass from the back, without moving anything
+	 *		twice. An element with a key that is already in the container replaces it.
+	 */
+	template<typename BidirIt>
+	void merge(BidirIt first, BidirIt last) {
+		const size_t n = base_type::size(), d = std::distance(first, last);
+		if (d == 0)
+			return;
+		base_type::resize(n + d);
+		value_type *const lo = base_type::data(), *const end = lo + n + d;
+		value_type *a = lo + n, *out = end;
+		while (last != first) {
+			if (a != lo && std::prev(last)->first < a[-1].first) {
+				*--out = std::move(*--a);
+			} else {
+				--last;
+				if (a != lo && !(a[-1].first < last->first))
+					--a;	// same key, the merged element wins
+				*--out = *last;
+			}
+		}
+		// [lo, a) is already in place, close the gap left by replaced elements
+		if (out != a) {
+			std::move(out, end, a);
+			base_type::resize(n + d - (out - a));
+		}
+		_refresh();
+	}
+	/// copy of x including its learned index and aggregate index, like the copy constructor
+	inline tuple_vector& operator=(const tuple_vector& x) {
+		base_type::operator=(x);
+		search_type::operator=(x);
+		m_aggregates = x.m_aggregates;
+		search_type::_rebase(base_type::data());
+		return *this;
+	}
+	/// like the move constructor, the elements are moved one by one only if the allocator demands it
+	inline tuple_vector& operator=(tuple_vector&& x) noexcept(std::is_nothrow_move_assignable<base_type>::value) {
+		base_type::operator=(std::move(x));
+		search_type::operator=(std::move(x));
+		m_aggregates = std::move(x.m_aggregates);
+		search_type::_rebase(base_type::data());
+		x._reset();
+		return *this;
 	}
-	inline tuple_vector<K, V>& operator=(const std::vector<value_type>& x) {
-		m_recompute_range = true;
-		return std::vector<value_type>::operator=(x);
+	inline tuple_vector& operator=(const base_type& x) {
+		base_type::operator=(x);
+		_refresh();
+		return *this;
 	}
-	inline tuple_vector<K, V>& operator=(std::vector<value_type>&& x) {
-		m_recompute_range = true;
-		return std::vector<value_type>::operator=(std::forward<std::vector<value_type>>(x));
+	inline tuple_vector& operator=(base_type&& x) {
+		base_type::operator=(std::forward<base_type>(x));
+		_refresh();
+		return *this;
 	}
-	inline tuple_vector<K, V>& operator=(std::initializer_list<value_type> il) {
-		m_recompute_range = true;
-		return std::vector<value_type>::operator=(il);
+	inline tuple_vector& operator=(std::initializer_list<value_type> il) {
+		base_type::operator=(il);
+		_refresh();
+		return *this;
 	}
 	inline void pop_back() {
-		std::vector<value_type>::pop_back();
-		m_recompute_range = true;
+		base_type::pop_back();
+		_refresh();
 	}
 	inline void push_back(const value_type& val) {
-		m_recompute_range = true;
-		std::vector<value_type>::push_back(val);
+		base_type::push_back(val);
+		_append();
 	}
 	inline void push_back(value_type&& val) {
-		m_recompute_range = true;
-		std::vector<value_type>::push_back(std::forward<value_type>(val));
+		base_type::push_back(std::forward<value_type>(val));
+		_append();
+	}
+	inline void reserve(size_type n) {
+		base_type::reserve(n);
+		_refresh();
 	}
 	inline void resize(size_type n) {
-		m_recompute_range = true;
-		std::vector<value_type>::resize(n);
+		base_type::resize(n);
+		_refresh();
 	}
 	inline void resize(size_type n, const value_type& val) {
-		m_recompute_range = true;
-		std::vector<value_type>::resize(n, val);
+		base_type::resize(n, val);
+		_refresh();
 	}
 	inline void shrink_to_fit() {
-		m_recompute_range = true;
-		std::vector<value_type>::shrink_to_fit();
+		base_type::shrink_to_fit();
+		_refresh();
 	}
-	inline void swap (std::vector<value_type> &x) {
-		m_recompute_range = true;
-		std::vector<value_type>::swap(x);
+	inline void swap (base_type &x) {
+		base_type::swap(x);
+		_refresh();
 	}
 
 	// Access operations
 	inline iterator at(const K &key) {
 		auto pos = find(key);
-		if (pos == std::vector<value_type>::end())
+		if (pos == base_type::end())
 			throw std::out_of_range("iterator tuple_vector::at(const K &key)");
 		return pos;
 	}
 	inline const_iterator at(const K &key) const {
-		auto pos = find(key);
-		if (pos == std::vector<value_type>::end())
+		return at(key, m_ctx);
+	}
+	inline const_iterator at(const K &key, context_type &ctx) const {
+		auto pos = find(key, ctx);
+		if (pos == base_type::end())
 			throw std::out_of_range("const_iterator tuple_vector::at(const K &key) const");
 		return pos;
 	}
 	inline const value_type &operator[](size_t idx) const {
-		return std::vector<value_type>::operator [](idx);
+		return base_type::operator [](idx);
 	}
 	inline value_type &operator[](size_t idx) {
-		return std::vector<value_type>::operator [](idx);
+		return base_type::operator [](idx);
 	}
 	inline const value_type &operator[](const K &key) const {
-		return lower_bound(key);
+		return *lower_bound(key);
 	}
 	inline value_type &operator[](const K &key) {
-		return lower_bound(key);
+		return *lower_bound(key);
 	}
 	inline iterator lower_bound(const K &key) {
-		return iterator(const_cast<value_type *>(_lower_bound(key)));
+		return iterator(const_cast<value_type *>(search_type::_lower_bound(key, m_ctx)));
 	}
 	inline const_iterator lower_bound(const K &key) const {
-		return const_iterator(_lower_bound(key));
+		return lower_bound(key, m_ctx);
+	}
+	/// lower_bound() using the given search context, safe to call from several threads at once
+	inline const_iterator lower_bound(const K &key, context_type &ctx) const {
+		return const_iterator(search_type::_lower_bound(key, ctx));
 	}
 	inline iterator find(const K &key) {
-		return iterator(const_cast<value_type *>(_find(key)));
+		return iterator(const_cast<value_type *>(search_type::_find(key, m_ctx)));
 	}
 	inline const_iterator find(const K &key) const {
-		return const_iterator(_find(key));
+		return find(key, m_ctx);
+	}
+	/// find() using the given search context, safe to call from several threads at once
+	inline const_iterator find(const K &key, context_type &ctx) const {
+		return const_iterator(search_type::_find(key, ctx));
+	}
+	/**
+	 * \brief find() for a whole range of sorted or unsorted keys
+	 * \param out receives the index of every key, size() if the key was not found
+	 */
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt find_many(InputIt first, InputIt last, OutputIt out) const {
+		return find_many(first, last, out, m_ctx);
+	}
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt find_many(InputIt first, InputIt last, OutputIt out, context_type &ctx) const {
+		return search_type::_search_many(first, last, out, true, ctx);
+	}
+	/**
+	 * \brief lower_bound() for a whole range of sorted or unsorted keys
+	 * \param out receives the index of every lower bound, size() if there is none
+	 */
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt lower_bound_many(InputIt first, InputIt last, OutputIt out) const {
+		return lower_bound_many(first, last, out, m_ctx);
+	}
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt lower_bound_many(InputIt first, InputIt last, OutputIt out, context_type &ctx) const {
+		return search_type::_search_many(first, last, out, false, ctx);
+	}
+	inline iterator upper_bound(const K &key) {
+		return iterator(const_cast<value_type *>(search_type::_upper_bound(key, m_ctx)));
+	}
+	inline const_iterator upper_bound(const K &key) const {
+		return upper_bound(key, m_ctx);
+	}
+	/// upper_bound() using the given search context, safe to call from several threads at once
+	inline const_iterator upper_bound(const K &key, context_type &ctx) const {
+		return const_iterator(search_type::_upper_bound(key, ctx));
+	}
+	inline std::pair<iterator, iterator> equal_range(const K &key) {
+		auto first = lower_bound(key);
+		return std::make_pair(first, first != base_type::end() && first->first == key ? first + 1 : first);
+	}
+	inline std::pair<const_iterator, const_iterator> equal_range(const K &key) const {
+		return equal_range(key, m_ctx);
+	}
+	/// equal_range() using the given search context, safe to call from several threads at once
+	inline std::pair<const_iterator, const_iterator> equal_range(const K &key, context_type &ctx) const {
+		auto first = lower_bound(key, ctx);
+		return std::make_pair(first, first != base_type::end() && first->first == key ? first + 1 : first);
 	}
 
-	/// Reset housekeeping variables. Just for completeness - normally you don't need to call this.
-	void reset() {
-		m_recompute_range = true;
-		m_hits = 0;
-		m_outofbound = 0;
-		m_recompute = 0;
-		m_resync = 0;
-		m_avg_diff = 0;
+	/**
+	 * \brief build the optional aggregate index over all values, see aggregate_index
+	 *		Once built, it is kept up-to-date by all modifying operations, appends extend it. Values
+	 *		changed in place through an iterator or operator[] are not tracked, call
+	 *		build_aggregates() again after doing so.
+	 */
+	void build_aggregates() {
+		m_aggregates.build(base_type::size(), value_at());
 	}
+	/// remove the aggregate index, aggregate() goes back to walking the window
+	void drop_aggregates() { m_aggregates.drop(); }
+	/// memory used by the aggregate index in bytes
+	size_t aggregate_bytes() const { return m_aggregates.bytes(); }
 
-	int hits() const { return m_hits; }
-	int outofbound() const { return m_outofbound; }
-	int recompute() const { return m_recompute; }
-	int resync() const { return m_resync; }
-	double avg_diff() const { return m_avg_diff; }
+	/**
+	 * \brief count, sum, min and max of all values with keys in [t0, t1)
+	 *		Costs a lower_bound() search for each end of the window (the second one is a short scan
+	 *		for short windows) plus O(1) with the aggregate index (see build_aggregates()) or a walk
+	 *		over the window without it.
+	 */
+	inline window_aggregate<V> aggregate(const K &t0, const K &t1) const {
+		return aggregate(t0, t1, m_ctx);
+	}
+	/// aggregate() using the given search context, safe to call from several threads at once
+	inline window_aggregate<V> aggregate(const K &t0, const K &t1, context_type &ctx) const {
+		const value_type *first = search_type::_lower_bound(t0, ctx);
+		return _aggregate(first, t0 < t1 ? search_type::_lower_bound_after(first, t1, ctx) : first);
+	}
 
 protected:
-	inline const value_type *_find(const K &key) const
-	{
-		const value_type *rc = nullptr;
-
-		// need to keep internal house-keeping variables in sync?
-		if (m_recompute_range) {
-			// get current size of vector
-			m_size = std::vector<value_type>::size();
-			// calculate the "total range" or time difference between front and back elements
-			m_total_range = ::key<K>()(std::vector<value_type>::back().first) - ::key<K>()(std::vector<value_type>::front().first);
-			// how much "time" does one element occupy
-			m_element_range = m_total_range / (m_size-1);
-			m_offset = 0;
-			// get pointer to first element - this serves as the lower bound when searching for key
-			m_front = &std::vector<value_type>::front();
-			// get pointer to last element - this serves as the upper bound when searching for key
-			m_back = &std::vector<value_type>::back();
-			// keep a count of how many times we were called
-			++m_recompute;
-			// done updating internal house-keeping
-			m_recompute_range = false;
-		}
-
-		// if there is no data, we are already done
-		if (m_size == 0)
-			return std::vector<value_type>::_M_impl._M_finish;
+	/// functor returning the value of the i-th element for the aggregate index
+	struct value_at_type {
+		const value_type *front;
+		inline const V &operator()(size_t i) const { return front[i].second; }
+	};
+	inline value_at_type value_at() const { return value_at_type{base_type::data()}; }
 
-		// compute the initial guess where we could find the searched key by interpolating
-		size_t idx = (::key<K>()(key) - ::key<K>()(std::vector<value_type>::front().first)) / m_element_range + m_offset;
-
-		// check bounds first
-		if (idx >= 0 && idx < m_size) {
-			// ok, we are within bounds - get element
-			rc = &std::vector<value_type>::operator[](idx);
-		} else {
-			// out-of-bounds, get either front or back element, depending on the index
-			if (idx > m_size)
-				rc = &std::vector<value_type>::back();
-			else
-				rc = &std::vector<value_type>::front();
-			m_offset = 0;
-			// maintain an out-of-bounds counter for information purposes
-			++m_outofbound;
-		}
-		// if we already found our key, return it
-		if (rc->first == key) {
-			++m_hits;
-			return rc;
-		}
-		const value_type *old_rc = rc;
-		// perform a search backward or forward, depending on were we landed
-		if (rc->first > key)
-			for (; rc->first > key && rc > m_front; --rc);
-		else
-			for (; rc->first < key && rc < m_back; ++rc);
-		m_avg_diff *= m_resync;
-		m_avg_diff += rc - old_rc;
-		m_offset += rc - old_rc;
-		++m_resync;
-		m_avg_diff /= m_resync;
-		m_offset = (double)m_offset + m_avg_diff + .5;
-
-		// did we find the sought key? return it
-		if (rc->first == key)
-			return rc;
-
-		// not found? return end()
-		return std::vector<value_type>::_M_impl._M_finish;
+	/// count, sum, min and max of the values of the elements in [first, last)
+	inline window_aggregate<V> _aggregate(const value_type *first, const value_type *last) const {
+		const value_type *front = base_type::data();
+		return m_aggregates.enabled() ? m_aggregates.query(first - front, last - front, value_at())
+			: aggregate_index<V>::walk(first - front, last - front, value_at());
 	}
 
-	inline const value_type *_lower_bound(const K &key) const
-	{
-		const value_type *rc = nullptr;
-
-		if (m_recompute_range) {
-			m_size = std::vector<value_type>::size();
-			m_total_range = ::key<K>()(std::vector<value_type>::back().first) - ::key<K>()(std::vector<value_type>::front().first);
-			m_element_range = m_total_range / (m_size-1);
-			m_offset = 0;
-			m_recompute_range = false;
-			m_front = &std::vector<value_type>::front();
-			m_back = &std::vector<value_type>::back();
-			++m_recompute;
-		}
-
-		if (m_size == 0)
-			return std::vector<value_type>::_M_impl._M_finish;
-
-		size_t idx = (::key<K>()(key) - ::key<K>()(std::vector<value_type>::front().first)) / m_element_range + m_offset;
-
-		if (idx >= 0 && idx < m_size) {
-			rc = &std::vector<value_type>::operator[](idx);
-		} else {
-			if (idx > m_size)
-				rc = &std::vector<value_type>::back();
-			else
-				rc = &std::vector<value_type>::front();
-			m_offset = 0;
-			// maintain an out-of-bounds counter for information purposes
-			++m_outofbound;
-		}
-		const value_type *old_rc = rc;
-		if (rc->first > key) {
-			for (; rc->first > key && rc > m_front; --rc);
-			if (rc->first < key)
-				++rc;
-		} else {
-			for (; rc->first < key && rc < m_back; ++rc);
-			if (rc->first < key)
-				--rc;
-		}
-		m_avg_diff *= m_resync;
-		m_avg_diff += rc - old_rc;
-		m_offset += rc - old_rc;
-		++m_resync;
-		m_avg_diff /= m_resync;
-		m_offset = (double)m_offset + m_avg_diff + .5;
-
-		if (rc->first >= key)
-			return rc;
-		return std::vector<value_type>::_M_impl._M_finish;
+	/// empty the moved-from container and drop everything built over its elements
+	inline void _reset() noexcept {
+		base_type::clear();
+		search_type::_reset(base_type::data());
+		m_aggregates.drop();
+	}
+	inline void _refresh() {
+		search_type::_refresh(base_type::data(), base_type::size());
+		if (m_aggregates.enabled())
+			build_aggregates();
+	}
+	inline void _append() {
+		search_type::_append(base_type::data(), base_type::size());
+		if (m_aggregates.enabled())
+			m_aggregates.extend(base_type::size(), value_at());
 	}
 
 private:
-	/// number of elements currently in tuple_vector
-	mutable size_t m_size = 0;
-	/// "total range" or time difference between first and last element in tuple_vector
-	mutable double m_total_range = 0;
-	/// how much "time" does one element occupy within tuple_vector (adjusted)
-	mutable double m_element_range = 0;
-	/// offset added to the initial interpolation guess to compensate for "time" gaps
-	mutable int m_offset = 0;
-	/// running average difference between key we guessed at first try and key we landed on after resync
-	mutable double m_avg_diff = 0;
-	/// flag set in modifying methods in order to trigger housekeeping in find() and lower_bound()
-	mutable bool m_recompute_range = false;
-	/// count how often a key was found on the first try
-	mutable int m_hits = 0;
-	/// how often a resync was necessary, i.e. when a key was not found on the first try
-	mutable int m_resync = 0;
-	/// how often the internal housekeeping code was called
-	mutable int m_recompute = 0;
-	/// how often a searched triggered an out-of-bounds condition
-	mutable int m_outofbound = 0;
-	/// pointer to the first element in this tuple_vector
-	mutable const value_type *m_front = nullptr;
-	/// pointer to the last element in this tuple_vector
-	mutable const value_type *m_back = nullptr;
+	/// optional aggregate index over the values, see build_aggregates()
+	aggregate_index<V> m_aggregates;
 };
 
 #endif /* __tuple_vector_h */
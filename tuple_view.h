@@ -0,0 +1,175 @@
+/**
+ * \file	tuple_view.h
+ * \author  Sinisa Susnjar <sinisa.susnjar@gmail.com>
+ * \version 0.01
+ */
+
+#ifndef __tuple_view_h
+#define __tuple_view_h
+
+#include <array>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "tuple_vector.h"
+
+/**
+ * \brief true for containers which own their elements, a tuple_view of a temporary one would dangle
+ *		This covers std::array and std::vector and everything derived from it like tuple_vector and
+ *		multi_tuple_vector. Anything else is taken to be a non-owning view like std::span, so
+ *		specialise this for other owning containers, just like key<K>.
+ * \tparam C container type
+ */
+template<typename C, typename = void>
+struct is_owning_container : std::false_type { };
+
+template<typename C>
+struct is_owning_container<C, typename std::enable_if<
+	std::is_base_of<std::vector<typename C::value_type, typename C::allocator_type>, C>::value>::type> : std::true_type { };
+
+template<typename T, size_t N>
+struct is_owning_container<std::array<T, N>> : std::true_type { };
+
+/**
+ * \brief A non-owning, read-only view of a contiguous sequence of std::pair<K,V> elements with
+ *		strictly increasing keys which lives somewhere else, e.g. a receive buffer or a
+ *		std::vector filled by other code. It offers the same find(), lower_bound(), at() etc.
+ *		as tuple_vector without copying anything, like a std::span with an interpolation
+ *		search on top. The viewed memory must outlive the view and must not change behind its
+ *		back: call extend() after elements were appended to the buffer in place, reset() after
+ *		anything else.
+ * \tparam K A datetime type, e.g. time_t, boost::posix_time::ptime or similar.
+ * \tparam V A value type, can be whatever is appropriate for the use-case.
+ * \tparam Stats lookup statistics policy, no_search_stats (default) or search_stats
+ */
+template<typename K, typename V, typename Stats = no_search_stats>
+class tuple_view : public interpolation_search<K, std::pair<K,V>, Stats> {
+	typedef interpolation_search<K, std::pair<K,V>, Stats> search_type;
+	using search_type::m_ctx;
+	using search_type::m_size;
+public:
+	typedef std::pair<K,V>										value_type;
+	typedef const value_type									*const_iterator;
+	typedef const_iterator										iterator;
+	typedef const value_type									&const_reference;
+	typedef size_t												size_type;
+	typedef typename search_type::context_type					context_type;
+
+	tuple_view() { }
+
+	/// view of the n elements at data
+	tuple_view(const value_type *data, size_type n) { reset(data, n); }
+
+	/// view of a contiguous container with data() and size(), e.g. std::vector, std::array or std::span
+	template<typename C, typename = decltype(std::declval<const C &>().data() + std::declval<const C &>().size())>
+	explicit tuple_view(const C &c) { reset(c.data(), c.size()); }
+	/**
+	 * \brief a view of a temporary container would dangle as soon as the statement ends
+	 *		Only owning containers are rejected (see is_owning_container), a temporary
+	 *		non-owning view like std::span is still accepted.
+	 */
+	template<typename C, typename = decltype(std::declval<const C &>().data() + std::declval<const C &>().size()),
+		typename = typename std::enable_if<is_owning_container<C>::value>::type>
+	tuple_view(const C &&) = delete;
+
+	/// view the n elements at data from now on
+	inline void reset(const value_type *data, size_type n) {
+		m_data = data;
+		search_type::_refresh(m_data, n);
+	}
+	/// n elements were appended in place after the viewed ones, the buffer did not move
+	inline void extend(size_type n) {
+		search_type::_append(m_data, m_size + n);
+	}
+
+	// Capacity
+	inline size_type size() const noexcept { return m_size; }
+	inline bool empty() const noexcept { return m_size == 0; }
+	inline const value_type *data() const noexcept { return m_data; }
+
+	// Iterators
+	inline const_iterator begin() const noexcept { return m_data; }
+	inline const_iterator end() const noexcept { return m_data + m_size; }
+	inline const_iterator cbegin() const noexcept { return begin(); }
+	inline const_iterator cend() const noexcept { return end(); }
+
+	// Access operations
+	inline const_iterator at(const K &key) const {
+		return at(key, m_ctx);
+	}
+	inline const_iterator at(const K &key, context_type &ctx) const {
+		auto pos = find(key, ctx);
+		if (pos == end())
+			throw std::out_of_range("const_iterator tuple_view::at(const K &key) const");
+		return pos;
+	}
+	inline const_reference operator[](size_t idx) const {
+		return m_data[idx];
+	}
+	inline const_reference operator[](const K &key) const {
+		return *lower_bound(key);
+	}
+	inline const_reference front() const { return *begin(); }
+	inline const_reference back() const { return *(end() - 1); }
+	inline const_iterator lower_bound(const K &key) const {
+		return lower_bound(key, m_ctx);
+	}
+	/// lower_bound() using the given search context, safe to call from several threads at once
+	inline const_iterator lower_bound(const K &key, context_type &ctx) const {
+		return search_type::_lower_bound(key, ctx);
+	}
+	inline const_iterator find(const K &key) const {
+		return find(key, m_ctx);
+	}
+	/// find() using the given search context, safe to call from several threads at once
+	inline const_iterator find(const K &key, context_type &ctx) const {
+		return search_type::_find(key, ctx);
+	}
+	/**
+	 * \brief find() for a whole range of sorted or unsorted keys
+	 * \param out receives the index of every key, size() if the key was not found
+	 */
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt find_many(InputIt first, InputIt last, OutputIt out) const {
+		return find_many(first, last, out, m_ctx);
+	}
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt find_many(InputIt first, InputIt last, OutputIt out, context_type &ctx) const {
+		return search_type::_search_many(first, last, out, true, ctx);
+	}
+	/**
+	 * \brief lower_bound() for a whole range of sorted or unsorted keys
+	 * \param out receives the index of every lower bound, size() if there is none
+	 */
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt lower_bound_many(InputIt first, InputIt last, OutputIt out) const {
+		return lower_bound_many(first, last, out, m_ctx);
+	}
+	template<typename InputIt, typename OutputIt>
+	inline OutputIt lower_bound_many(InputIt first, InputIt last, OutputIt out, context_type &ctx) const {
+		return search_type::_search_many(first, last, out, false, ctx);
+	}
+	inline const_iterator upper_bound(const K &key) const {
+		return upper_bound(key, m_ctx);
+	}
+	/// upper_bound() using the given search context, safe to call from several threads at once
+	inline const_iterator upper_bound(const K &key, context_type &ctx) const {
+		return search_type::_upper_bound(key, ctx);
+	}
+	inline std::pair<const_iterator, const_iterator> equal_range(const K &key) const {
+		return equal_range(key, m_ctx);
+	}
+	/// equal_range() using the given search context, safe to call from several threads at once
+	inline std::pair<const_iterator, const_iterator> equal_range(const K &key, context_type &ctx) const {
+		auto first = lower_bound(key, ctx);
+		return std::make_pair(first, first != end() && first->first == key ? first + 1 : first);
+	}
+
+private:
+	/// the viewed elements, their number is kept by interpolation_search
+	const value_type *m_data = nullptr;
+};
+
+#endif /* __tuple_view_h */